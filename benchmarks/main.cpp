@@ -0,0 +1,298 @@
+#include <iostream>
+#include <chrono>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <thread>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+#include "gclib.hpp"
+
+
+//number of times each benchmark is run; the best time is reported
+static const int RunCount = 5;
+
+
+std::atomic<int> count{ 0 };
+
+
+template <class F> double timeFunction(F&& func) {
+    auto start = std::chrono::high_resolution_clock::now();
+    func();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+}
+
+
+//runs a benchmark a number of times and reports the best time; the benchmark must not modify the object count
+template <class F> void doBenchmark(const std::string& name, F&& func) {
+    std::cout << "Benchmark: " << name;
+    const int prevCount = count;
+    double best = timeFunction(func);
+    for (int run = 1; run < RunCount; ++run) {
+        best = std::min(best, timeFunction(func));
+    }
+    if (count == prevCount) {
+        std::cout << ": " << best << " seconds.\n";
+    }
+    else {
+        std::cout << ": ERROR: objects were destroyed.\n";
+    }
+}
+
+
+//collects the given number of times
+static void collect(int collectionCount) {
+    for (int index = 0; index < collectionCount; ++index) {
+        GC::collect();
+    }
+}
+
+
+struct TreeNode {
+    GCPtr<TreeNode> left;
+    GCPtr<TreeNode> right;
+
+    TreeNode() {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~TreeNode() {
+        count.fetch_sub(1, std::memory_order_relaxed);
+    }
+};
+
+
+static GCPtr<TreeNode> createTree(int depth) {
+    GCPtr<TreeNode> node = gcnew<TreeNode>();
+    if (depth > 1) {
+        node->left = createTree(depth - 1);
+        node->right = createTree(depth - 1);
+    }
+    return node;
+}
+
+
+struct TracedTreeNode {
+    GCBasicPtr<TracedTreeNode> left;
+    GCBasicPtr<TracedTreeNode> right;
+
+    TracedTreeNode() {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~TracedTreeNode() {
+        count.fetch_sub(1, std::memory_order_relaxed);
+    }
+};
+
+
+GC_TRACE(TracedTreeNode, left, right);
+
+
+static GCPtr<TracedTreeNode> createTracedTree(int depth) {
+    GCPtr<TracedTreeNode> node = gcnew<TracedTreeNode>();
+    if (depth > 1) {
+        node->left = createTracedTree(depth - 1);
+        node->right = createTracedTree(depth - 1);
+    }
+    return node;
+}
+
+
+struct ScannableTreeNode : GCIScannableObject {
+    GCBasicPtr<ScannableTreeNode> left;
+    GCBasicPtr<ScannableTreeNode> right;
+
+    ScannableTreeNode() {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~ScannableTreeNode() {
+        count.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void scan(GCTracer& tracer) const noexcept final {
+        left.scan(tracer);
+        right.scan(tracer);
+    }
+};
+
+
+static GCPtr<ScannableTreeNode> createScannableTree(int depth) {
+    GCPtr<ScannableTreeNode> node = gcnew<ScannableTreeNode>();
+    if (depth > 1) {
+        node->left = createScannableTree(depth - 1);
+        node->right = createScannableTree(depth - 1);
+    }
+    return node;
+}
+
+
+struct ListNode {
+    GCPtr<ListNode> next;
+
+    ListNode() {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~ListNode() {
+        count.fetch_sub(1, std::memory_order_relaxed);
+    }
+};
+
+
+static const size_t PointerTableSize = 1 << 20;
+static const size_t PointerTableNodeCount = 1000;
+
+
+//creates a table of pointers that are mostly null or point outside of the heap
+static GCPtr<GCBasicPtr<ListNode>> createPointerTable() {
+    static int notInHeap[16];
+    GCPtr<GCBasicPtr<ListNode>> table = gcnewArray<GCBasicPtr<ListNode>>(PointerTableSize);
+    for (size_t index = 0; index < PointerTableSize; index += 64) {
+        table[index] = reinterpret_cast<ListNode*>(&notInHeap[index / 64 % 16]);
+        table[index + 1] = reinterpret_cast<ListNode*>(~uintptr_t(0) - index);
+    }
+    for (size_t index = 0; index < PointerTableNodeCount; ++index) {
+        table[index * (PointerTableSize / PointerTableNodeCount) + 7] = gcnew<ListNode>();
+    }
+    return table;
+}
+
+
+struct GraphNode {
+    GCPtr<GraphNode> edges[4];
+
+    GraphNode() {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~GraphNode() {
+        count.fetch_sub(1, std::memory_order_relaxed);
+    }
+};
+
+
+//creates a graph of nodes with random edges; only the nodes of the first half are reachable from the first one,
+//since they point only to each other; the nodes of the second half are garbage, freed before marking is measured
+static GCPtr<GraphNode> createRandomGraph(size_t nodeCount, unsigned seed) {
+    std::mt19937 random(seed);
+    std::vector<GCPtr<GraphNode>> nodes(nodeCount);
+    for (GCPtr<GraphNode>& node : nodes) {
+        node = gcnew<GraphNode>();
+    }
+    const size_t halfCount = nodeCount / 2;
+    for (size_t index = 0; index < nodeCount; ++index) {
+        const size_t range = index < halfCount ? halfCount : nodeCount;
+        nodes[index]->edges[0] = nodes[(index + 1) % nodeCount];
+        for (size_t edge = 1; edge < 4; ++edge) {
+            nodes[index]->edges[edge] = nodes[random() % range];
+        }
+    }
+    nodes[halfCount - 1]->edges[0] = nodes[0];
+    return nodes[0];
+}
+
+
+//marking a tree, whose nodes register their member pointers
+static void benchmarkTree(const std::string& name, bool hugePages) {
+    const bool prevHugePages = GC::getHugePages();
+    GC::setHugePages(hugePages);
+
+    //the tree is allocated by a new thread, so as that it is allocated from new arena pages
+    GCPtr<TreeNode> root;
+    std::thread([&]() { root = createTree(19); }).join();
+    GC::setHugePages(prevHugePages);
+
+    doBenchmark(name, []() { collect(10); });
+    root = nullptr;
+    GC::collect();
+}
+
+
+//marking a tree, whose nodes declare their member pointers via GC_TRACE
+static void benchmarkTracedTree() {
+    GCPtr<TracedTreeNode> root;
+    std::thread([&]() { root = createTracedTree(19); }).join();
+    doBenchmark("marking 2^19 traced tree nodes 10 times", []() { collect(10); });
+    root = nullptr;
+    GC::collect();
+}
+
+
+//tracing a table of pointers is bounded by memory bandwidth
+static void benchmarkPointerTable() {
+    GCPtr<GCBasicPtr<ListNode>> table = createPointerTable();
+    doBenchmark("tracing a table of 2^20 pointers 10 times", []() { collect(10); });
+    table = nullptr;
+    GC::collect();
+}
+
+
+//marking a random graph is bound by cache misses, which prefetching overlaps
+static void benchmarkRandomGraph() {
+    const size_t prevPrefetchDistance = GC::getPrefetchDistance();
+    GCPtr<GraphNode> root = createRandomGraph(1 << 19, 0);
+    GC::collect();
+    for (size_t prefetchDistance : { 0, 4, 8, 16 }) {
+        GC::setPrefetchDistance(prefetchDistance);
+        doBenchmark("marking the 2^18 reachable nodes of a random graph of 2^19 nodes 10 times, prefetch distance " + std::to_string(prefetchDistance), []() { collect(10); });
+    }
+    GC::setPrefetchDistance(prevPrefetchDistance);
+    root = nullptr;
+    GC::collect();
+}
+
+
+//collects a number of times and reports the shortest of the longest pauses of the collections
+static void benchmarkLongestPause(const std::string& name) {
+    std::cout << "Benchmark: " << name;
+    const int prevCount = count;
+    std::chrono::microseconds best = std::chrono::microseconds::max();
+    for (int run = 0; run < RunCount; ++run) {
+        GC::collect();
+        best = std::min(best, GC::getLastPauseDuration());
+    }
+    if (count == prevCount) {
+        std::cout << ": " << best.count() << " microseconds.\n";
+    }
+    else {
+        std::cout << ": ERROR: objects were destroyed.\n";
+    }
+}
+
+
+//objects with manually traced pointers are scanned in the final pause of concurrent marking, which grows with their number
+static void benchmarkFinalPause() {
+    const bool prevConcurrentMarking = GC::getConcurrentMarking();
+    GC::setConcurrentMarking(true);
+    {
+        GCPtr<TreeNode> root = createTree(17);
+        GC::collect();
+        benchmarkLongestPause("longest pause of concurrent marking, 2^17 tree nodes with gc pointers");
+    }
+    {
+        GCPtr<ScannableTreeNode> root = createScannableTree(17);
+        GC::collect();
+        benchmarkLongestPause("longest pause of concurrent marking, 2^17 tree nodes with manually traced pointers");
+    }
+    GC::setConcurrentMarking(prevConcurrentMarking);
+    GC::collect();
+}
+
+
+int main() {
+    std::cout << std::fixed;
+
+    benchmarkTree("marking 2^19 tree nodes 10 times, normal pages", false);
+    benchmarkTree("marking 2^19 tree nodes 10 times, huge pages", true);
+    benchmarkTracedTree();
+    benchmarkPointerTable();
+    benchmarkRandomGraph();
+    benchmarkFinalPause();
+
+    system("pause");
+    return 0;
+}
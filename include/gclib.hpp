@@ -6,7 +6,10 @@
 #include "gclib/GCBasicPtr.hpp"
 #include "gclib/GCCustomBlockHeaderVTable.hpp"
 #include "gclib/gcnew.hpp"
+#include "gclib/GCLocalPtr.hpp"
 #include "gclib/GCPtr.hpp"
+#include "gclib/GCTrace.hpp"
+#include "gclib/GCWeakPtr.hpp"
 
 
 #endif //GCLIB_HPP
@@ -2,6 +2,10 @@
 #define GCLIB_GC_HPP
 
 
+#include <cstddef>
+#include <chrono>
+
+
 /**
  * Interface to the collector.
  */
@@ -9,17 +13,36 @@ class GC {
 public:
     /**
      * Collects garbage synchronously.
+     * In generational mode, only the young generation is collected, 
+     * unless the old generation has grown past the full collection threshold.
+     * If there is a pause budget, full collections mark blocks incrementally, and this call may only run one slice.
      * @return number of allocated bytes after the collection.
      */
     static size_t collect();
 
+    /**
+     * Collects garbage synchronously, including the old generation.
+     * An incremental collection in progress is completed.
+     * @return number of allocated bytes after the collection.
+     */
+    static size_t collectFull();
+
     /**
      * Collects data asynchronously. 
      */
     static void collectAsync();
 
+    /**
+     * Explicit safepoint.
+     * Threads are stopped for collection only while they are outside of regions in which pointers are modified;
+     * a thread that does not allocate or modify pointers for a long time can call this function to wait 
+     * for a pending collection to finish, instead of running along with it.
+     */
+    static void safepoint();
+
     /**
      * Returns the current allocation size.
+     * Each thread counts its own allocations; this function aggregates the counters of all threads.
      * @return the current allocation size.
      */
     static size_t getAllocSize();
@@ -35,6 +58,248 @@ public:
      * @param limit new allocation limit.
      */
     static void setAllocLimit(size_t limit);
+
+    /**
+     * Checks if unreachable blocks are swept lazily.
+     * @return true if sweeping is lazy, false otherwise; initially false.
+     */
+    static bool getLazySweep();
+
+    /**
+     * Enables/disables lazy sweeping.
+     * If enabled, collection does not finalize the unreachable blocks; they are queued instead,
+     * and each thread that allocates memory sweeps a few of them before each allocation,
+     * so as that the collection pause consists only of marking.
+     * If disabled, the blocks are finalized by the thread that collects garbage, along with any queued blocks.
+     * @param lazy if true, sweeping is lazy.
+     */
+    static void setLazySweep(bool lazy);
+
+    /**
+     * Checks if unreachable blocks are swept by a background thread.
+     * @return true if sweeping is in the background, false otherwise; initially false.
+     */
+    static bool getBackgroundSweep();
+
+    /**
+     * Enables/disables background sweeping.
+     * If enabled, collection does not finalize the unreachable blocks; they are handed off to a background thread,
+     * and collection returns as soon as the threads are resumed.
+     * @param background if true, sweeping is in the background.
+     */
+    static void setBackgroundSweep(bool background);
+
+    /**
+     * Returns the number of threads that finalize and free unreachable blocks in parallel, 
+     * including the thread that sweeps.
+     * @return the number of sweeper threads; initially 1.
+     */
+    static size_t getSweeperThreadCount();
+
+    /**
+     * Sets the number of threads that finalize and free unreachable blocks in parallel, 
+     * including the thread that sweeps.
+     * With more than one thread, finalizers of different objects might run concurrently.
+     * @param count number of sweeper threads; if 0, it is set to 1.
+     */
+    static void setSweeperThreadCount(size_t count);
+
+    /**
+     * Sweeps all the blocks queued for lazy/background sweeping,
+     * and waits for the blocks being swept by other threads.
+     * It must not be invoked from a finalizer.
+     */
+    static void sweep();
+
+    /**
+     * Returns the maximum size of free arena pages that are retained instead of being returned to the system.
+     * @return the retention size, in bytes; initially 0.
+     */
+    static size_t getMemoryRetention();
+
+    /**
+     * Sets the maximum size of free arena pages that are retained instead of being returned to the system.
+     * The memory of free pages beyond this size is returned to the system during collection,
+     * so as that the resident memory of the process is bounded after the garbage is swept.
+     * @param size the retention size, in bytes.
+     */
+    static void setMemoryRetention(size_t size);
+
+    /**
+     * Returns the minimum time an arena page must be free before its memory is returned to the system.
+     * @return the decay time; initially 1 second.
+     */
+    static std::chrono::milliseconds getMemoryDecayTime();
+
+    /**
+     * Sets the minimum time an arena page must be free before its memory is returned to the system.
+     * Pages that are reused shortly after they become free are not released, 
+     * in order to avoid the cost of faulting their memory in again.
+     * @param time the decay time.
+     */
+    static void setMemoryDecayTime(std::chrono::milliseconds time);
+
+    /**
+     * Returns the memory of free arena pages beyond the retention size to the system immediately,
+     * regardless of the decay time.
+     * @return number of bytes returned to the system; 0 if a collection is in progress.
+     */
+    static size_t releaseMemory();
+
+    /**
+     * Checks if arena pages are allocated from huge page regions.
+     * @return true if huge pages are enabled, false otherwise; initially false.
+     */
+    static bool getHugePages();
+
+    /**
+     * Enables/disables huge pages for the arenas.
+     * If enabled, arena pages are allocated from 2 MB-aligned regions that are advised to be backed 
+     * by transparent huge pages (where supported), so as that marking touches far fewer TLB entries.
+     * If the system does not support transparent huge pages, the regions are backed by normal pages.
+     * It affects only the arena pages allocated from now on.
+     * @param hugePages if true, huge pages are enabled.
+     */
+    static void setHugePages(bool hugePages);
+
+    /**
+     * Returns the number of bytes mapped for large objects.
+     * Objects and arrays of at least 256 KB are mapped directly from the system,
+     * and they are unmapped when they are swept.
+     * @return the number of bytes mapped for large objects.
+     */
+    static size_t getLargeObjectSize();
+
+    /**
+     * Checks if generational collection is enabled.
+     * @return true if generational collection is enabled, false otherwise; initially false.
+     */
+    static bool getGenerational();
+
+    /**
+     * Enables/disables generational collection.
+     * In generational mode, blocks that survive a number of collections are promoted to the old generation,
+     * which is not marked by most collections; pointer modifications mark the card of the modified pointer,
+     * so as that only the old blocks that might point to young blocks are scanned.
+     * Toggling the mode resets the generations at the next collection.
+     * @param generational if true, generational collection is enabled.
+     */
+    static void setGenerational(bool generational);
+
+    /**
+     * Returns the number of young collections a block must survive in order to be promoted to the old generation.
+     * @return the promotion age; initially 2.
+     */
+    static size_t getPromotionAge();
+
+    /**
+     * Sets the number of young collections a block must survive in order to be promoted to the old generation.
+     * @param age the promotion age; it is clamped to the range 1 to 254.
+     */
+    static void setPromotionAge(size_t age);
+
+    /**
+     * Returns the growth of the old generation since the last full collection that causes the next collection to be full.
+     * @return the full collection threshold, in bytes; initially 32 MB.
+     */
+    static size_t getFullCollectionThreshold();
+
+    /**
+     * Sets the growth of the old generation since the last full collection that causes the next collection to be full.
+     * @param size the full collection threshold, in bytes.
+     */
+    static void setFullCollectionThreshold(size_t size);
+
+    /**
+     * Returns the size of the blocks promoted to the old generation.
+     * @return the old generation size, in bytes.
+     */
+    static size_t getOldGenerationSize();
+
+    /**
+     * Returns the maximum duration of the pauses of incremental marking.
+     * @return the pause budget; if zero, marking is not incremental. Initially zero.
+     */
+    static std::chrono::microseconds getPauseBudget();
+
+    /**
+     * Sets the maximum duration of the pauses of incremental marking.
+     * If not zero, full collections mark blocks in slices: each call to collect, either explicit or triggered
+     * by the allocation limit, marks blocks for at most the given time, then lets the threads run until the next slice,
+     * which the collection thread runs if no other thread calls collect. Between slices, pointer stores record 
+     * the overwritten values, and new objects are allocated marked. The first slice also scans the roots,
+     * and the last slice also scans the objects with manually traced pointers; collectFull completes the collection.
+     * @param budget the pause budget; if zero, marking is not incremental.
+     */
+    static void setPauseBudget(std::chrono::microseconds budget);
+
+    /**
+     * Returns the duration of the longest pause of the last collection, i.e. the longest time the threads were stopped;
+     * for incremental marking, the duration of the last slice.
+     * @return the duration of the longest pause of the last collection; initially zero.
+     */
+    static std::chrono::microseconds getLastPauseDuration();
+
+    /**
+     * Checks if an incremental collection is in progress, i.e. if more slices are required in order to complete it.
+     * @return true if an incremental collection is in progress, false otherwise.
+     */
+    static bool isCollecting();
+
+    /**
+     * Checks if full collections mark blocks along with the mutators.
+     * @return true if concurrent marking is enabled, false otherwise; initially false.
+     */
+    static bool getConcurrentMarking();
+
+    /**
+     * Enables/disables concurrent marking.
+     * When enabled, full collections stop the threads only briefly in order to scan the roots, 
+     * then the blocks are marked while the threads run, and a short final pause completes marking.
+     * While marking, pointer stores record the overwritten values in per-thread buffers (snapshot-at-the-beginning barrier), 
+     * new objects are allocated marked, and objects with manually traced pointers, or with member pointers 
+     * outside of the object memory (e.g. within containers), are scanned in the final pause.
+     * Since the scan functions of manually traced objects might read data the threads modify, they are not invoked
+     * while the threads run; the final pause therefore grows with the number of reachable objects that implement
+     * GCIScannableObject, and types declared via GC_TRACE keep it short (see GC::getLastPauseDuration).
+     * @param concurrent if true, concurrent marking is enabled.
+     */
+    static void setConcurrentMarking(bool concurrent);
+
+    /**
+     * Returns the number of blocks whose memory is prefetched before a block is scanned.
+     * @return the prefetch distance; initially 8.
+     */
+    static size_t getPrefetchDistance();
+
+    /**
+     * Sets the number of blocks whose memory is prefetched before a block is scanned.
+     * Markers take the blocks to scan through a queue of the given length: the cache lines of the pointer slots
+     * of a block, up to 8 of them, are prefetched when the block enters the queue, and the block is scanned
+     * when it leaves the queue; thus the cache misses of scanning the blocks overlap.
+     * @param distance the prefetch distance; if zero, nothing is prefetched. It is clamped to 32.
+     */
+    static void setPrefetchDistance(size_t distance);
+
+    /**
+     * Returns the size of the header that precedes each garbage-collected object or array,
+     * i.e. the per-object memory overhead of the collector.
+     * @return the block header size, in bytes.
+     */
+    static size_t getBlockHeaderSize();
+
+    /**
+     * Returns the number of threads that mark blocks in parallel, including the collecting thread.
+     * @return the number of marker threads; initially 1.
+     */
+    static size_t getMarkerThreadCount();
+
+    /**
+     * Sets the number of threads that mark blocks in parallel, including the collecting thread.
+     * Marker threads steal work from each other, so as that large object graphs are marked faster.
+     * @param count number of marker threads; if 0, it is set to 1.
+     */
+    static void setMarkerThreadCount(size_t count);
 };
 
 
@@ -4,6 +4,8 @@
 
 #include <stdexcept>
 #include "GCPtrOperations.hpp"
+#include "GCTracer.hpp"
+#include "GCTrace.hpp"
 
 
 /**
@@ -14,6 +16,9 @@
  * 
  * It can point to anything.
  * 
+ * As a member of a garbage-collected object, it is traced either manually, from the scan function
+ * of GCIScannableObject, or by the marker, if the member is declared via GC_TRACE.
+ * 
  * @param T type of object to point to.
  */
 template <class T> class GCBasicPtr {
@@ -193,9 +198,10 @@ public:
 
     /**
      * Used for manually scanning the pointer during the mark phase of the collection. 
+     * @param tracer the tracer passed to the scan function of the object that contains this pointer.
      */
-    void scan() const noexcept {
-        GCPtrOperations::scan(m_value);
+    void scan(GCTracer& tracer) const noexcept {
+        tracer.visit(m_value);
     }
 
 private:
@@ -204,4 +210,15 @@ private:
 };
 
 
+/**
+ * Layout of a basic pointer: the pointer value itself.
+ * Arrays of basic pointers, i.e. allocated by gcnewArray<GCBasicPtr<T>>, are traced by the marker in batches.
+ * @param T type of object to point to.
+ */
+template <class T> struct GCTrace<GCBasicPtr<T>> {
+    ///offset of the pointer value.
+    static constexpr std::array<size_t, 1> Offsets{{ 0 }};
+};
+
+
 #endif //GCLIB_GCBASICPTR_HPP
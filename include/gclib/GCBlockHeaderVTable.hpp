@@ -7,6 +7,7 @@
 #include "GCIBlockHeaderVTable.hpp"
 #include "GCIScannableObject.hpp"
 #include "gcmalloc.hpp"
+#include "gctraits.hpp"
 
 
 /**
@@ -15,16 +16,102 @@
  */
 template <class T> class GCBlockHeaderVTable : public GCIBlockHeaderVTable {
 public:
+    /**
+     * Traits of T.
+     * Gc pointers have non-trivial destructors, manually traced objects implement GCIScannableObject,
+     * and the pointers of types declared via GC_TRACE are found at the declared offsets;
+     * therefore a trivially destructible type that does not implement GCIScannableObject and is not declared via GC_TRACE
+     * contains no gc pointers, while any other type that does not implement GCIScannableObject has only the gc pointers 
+     * of the block's pointer list and of its pointer layout.
+     */
+    static constexpr uint8_t Traits = 
+        (std::is_trivially_destructible_v<T> ? TriviallyDestructible : 0) |
+        (std::is_trivially_destructible_v<T> && !std::is_base_of_v<GCIScannableObject, T> && GCTrace<T>::Offsets.empty() ? NoPtrs : 0) |
+        (!std::is_base_of_v<std::enable_shared_from_this<T>, T> ? NotShareable : 0) |
+        (!GCHasOperatorDelete<T>::Value ? DefaultAllocator : 0) |
+        ((!std::is_trivially_destructible_v<T> || !GCTrace<T>::Offsets.empty()) && !std::is_base_of_v<GCIScannableObject, T> ? NoScan : 0) |
+        (!GCTrace<T>::Offsets.empty() ? Traced : 0);
+
+    /**
+     * Returns the type descriptor of T with the given traits.
+     * The descriptor has no function pointers for the functions the traits make unnecessary.
+     * @param traits traits of the descriptor.
+     * @return the type descriptor.
+     */
+    static constexpr GCTypeDescriptor makeDescriptor(uint8_t traits) {
+        return { 
+            traits, 
+            { GCTrace<T>::Offsets.data(), GCTrace<T>::Offsets.size(), sizeof(T) },
+            traits & (NoPtrs | NoScan) ? nullptr : &scanObjects,
+            traits & TriviallyDestructible ? nullptr : &finalizeObjects,
+            &freeMemory,
+            traits & NotShareable ? nullptr : &sharedObjects,
+            nullptr
+        };
+    }
+
+    /**
+     * The type descriptor blocks allocated by gcnew<T> refer to.
+     * @param ExtraTraits traits to add to the traits of T.
+     */
+    template <uint8_t ExtraTraits = 0> static constexpr GCTypeDescriptor Descriptor = makeDescriptor(Traits | ExtraTraits);
+
+    /**
+     * The default constructor.
+     * @param extraTraits traits to add to the traits of T; 
+     *  for example, NoPtrs declares that the objects contain no gc pointers, and therefore they are not scanned.
+     */
+    GCBlockHeaderVTable(uint8_t extraTraits = 0) : GCIBlockHeaderVTable(makeDescriptor(Traits | extraTraits)) {
+    }
+
+    /**
+     * Scans for member pointers; see scanObjects.
+     * @param start memory start.
+     * @param end memory end.
+     * @param tracer tracer to visit the pointers with.
+     */
+    void scan(void* start, void* end, GCTracer& tracer) noexcept final {
+        scanObjects(start, end, tracer);
+    }
+
+    /**
+     * Finalizes the object; see finalizeObjects.
+     * @param start memory start.
+     * @param end memory end.
+     */
+    void finalize(void* start, void* end) noexcept final {
+        finalizeObjects(start, end);
+    }
+
+    /**
+     * Frees memory; see freeMemory.
+     * @param mem pointer to memory to free.
+     */
+    void free(void* mem) noexcept final {
+        freeMemory(mem);
+    }
+
+    /**
+     * Checks if the object is shared; see sharedObjects.
+     * @param start start of memory block.
+     * @param end end of memory block.
+     * @return true if objects have shared pointers to them, false otherwise.
+     */
+    bool shared(void* start, void* end) const noexcept final {
+        return sharedObjects(start, end);
+    }
+
     /**
      * Scans for member pointers.
      * If T implements the interface GCIScannableObject, then it calls 
      * the scan function of that interface, otherwise it does nothing.
      * @param start memory start.
      * @param end memory end.
+     * @param tracer tracer to visit the pointers with.
      */
-    void scan(void* start, void* end) noexcept final {
+    static void scanObjects(void* start, void* end, GCTracer& tracer) noexcept {
         if constexpr (std::is_base_of_v<GCIScannableObject, T>) {
-            reinterpret_cast<T*>(start)->GCIScannableObject::scan();
+            static_cast<const GCIScannableObject*>(reinterpret_cast<T*>(start))->scan(tracer);
         }
     }
 
@@ -33,7 +120,7 @@ public:
      * @param start memory start.
      * @param end memory end.
      */
-    void finalize(void* start, void* end) noexcept final {
+    static void finalizeObjects(void* start, void* end) noexcept {
         reinterpret_cast<T*>(start)->~T();
     }
 
@@ -41,7 +128,7 @@ public:
      * Frees memory either by using T::operator delete or global operator delete.
      * @param mem pointer to memory to free.
      */
-    void free(void* mem) noexcept final {
+    static void freeMemory(void* mem) noexcept {
         GCMalloc<T>::free(mem);
     }
 
@@ -54,7 +141,7 @@ public:
      * @param end end of memory block.
      * @return true if objects have shared pointers to them, false otherwise.
      */
-    bool shared(void* start, void* end) const noexcept final {
+    static bool sharedObjects(void* start, void* end) noexcept {
         if constexpr (std::is_base_of_v<std::enable_shared_from_this<T>, T>) {
             return !reinterpret_cast<T*>(start)->std::enable_shared_from_this<T>::weak_from_this().expired();
         }
@@ -71,6 +158,59 @@ public:
  */
 template <class T> class GCBlockHeaderVTable<T[]> : public GCIBlockHeaderVTable {
 public:
+    ///traits of T; see GCBlockHeaderVTable<T>::Traits.
+    static constexpr uint8_t Traits = 
+        (std::is_trivially_destructible_v<T> ? TriviallyDestructible : 0) |
+        (std::is_trivially_destructible_v<T> && !std::is_base_of_v<GCIScannableObject, T> && GCTrace<T>::Offsets.empty() ? NoPtrs : 0) |
+        (!std::is_base_of_v<std::enable_shared_from_this<T>, T> ? NotShareable : 0) |
+        (!GCHasOperatorDelete<T[]>::Value ? DefaultAllocator : 0) |
+        ((!std::is_trivially_destructible_v<T> || !GCTrace<T>::Offsets.empty()) && !std::is_base_of_v<GCIScannableObject, T> ? NoScan : 0) |
+        (!GCTrace<T>::Offsets.empty() ? Traced : 0);
+
+    ///returns the type descriptor of T[] with the given traits; see GCBlockHeaderVTable<T>::makeDescriptor.
+    static constexpr GCTypeDescriptor makeDescriptor(uint8_t traits) {
+        return { 
+            traits, 
+            { GCTrace<T>::Offsets.data(), GCTrace<T>::Offsets.size(), sizeof(T) },
+            traits & (NoPtrs | NoScan) ? nullptr : &scanObjects,
+            traits & TriviallyDestructible ? nullptr : &finalizeObjects,
+            &freeMemory,
+            traits & NotShareable ? nullptr : &sharedObjects,
+            nullptr
+        };
+    }
+
+    ///the type descriptor blocks allocated by gcnewArray<T> refer to; see GCBlockHeaderVTable<T>::Descriptor.
+    template <uint8_t ExtraTraits = 0> static constexpr GCTypeDescriptor Descriptor = makeDescriptor(Traits | ExtraTraits);
+
+    /**
+     * The default constructor.
+     * @param extraTraits traits to add to the traits of T; 
+     *  for example, NoPtrs declares that the objects contain no gc pointers, and therefore they are not scanned.
+     */
+    GCBlockHeaderVTable(uint8_t extraTraits = 0) : GCIBlockHeaderVTable(makeDescriptor(Traits | extraTraits)) {
+    }
+
+    ///scans for member pointers; see scanObjects.
+    void scan(void* start, void* end, GCTracer& tracer) noexcept final {
+        scanObjects(start, end, tracer);
+    }
+
+    ///finalizes the objects; see finalizeObjects.
+    void finalize(void* start, void* end) noexcept final {
+        finalizeObjects(start, end);
+    }
+
+    ///frees memory; see freeMemory.
+    void free(void* mem) noexcept final {
+        freeMemory(mem);
+    }
+
+    ///checks if the objects are shared; see sharedObjects.
+    bool shared(void* start, void* end) const noexcept final {
+        return sharedObjects(start, end);
+    }
+
     /**
      * Scans for member pointers.
      * If T implements the interface GCIScannableObject, then it calls 
@@ -78,11 +218,12 @@ public:
      * otherwise it does nothing.
      * @param start memory start.
      * @param end memory end.
+     * @param tracer tracer to visit the pointers with.
      */
-    void scan(void* start, void* end) noexcept final {
+    static void scanObjects(void* start, void* end, GCTracer& tracer) noexcept {
         if constexpr (std::is_base_of_v<GCIScannableObject, T>) {
             for (T* obj = reinterpret_cast<T*>(start); obj < end; ++obj) {
-                reinterpret_cast<T*>(obj)->GCIScannableObject::scan();
+                static_cast<const GCIScannableObject*>(obj)->scan(tracer);
             }
         }
     }
@@ -92,7 +233,7 @@ public:
      * @param start memory start.
      * @param end memory end.
      */
-    void finalize(void* start, void* end) noexcept final {
+    static void finalizeObjects(void* start, void* end) noexcept {
         for (T* obj = reinterpret_cast<T*>(end) - 1; obj >= start; --obj) {
             reinterpret_cast<T*>(obj)->~T();
         }
@@ -102,7 +243,7 @@ public:
      * Frees memory either by using T::operator delete[] or global operator delete[].
      * @param mem pointer to memory to free.
      */
-    void free(void* mem) noexcept final {
+    static void freeMemory(void* mem) noexcept {
         GCMalloc<T[]>::free(mem);
     }
 
@@ -115,7 +256,7 @@ public:
      * @param end end of memory block.
      * @return true if objects have shared pointers to them, false otherwise.
      */
-    bool shared(void* start, void* end) const noexcept final {
+    static bool sharedObjects(void* start, void* end) noexcept {
         if constexpr (std::is_base_of_v<std::enable_shared_from_this<T>, T>) {
             for (T* obj = reinterpret_cast<T*>(start); obj < end; ++obj) {
                 if (!obj->std::enable_shared_from_this<T>::weak_from_this().expired()) {
@@ -2,12 +2,14 @@
 #define GCLIB_GCCUSTOMBLOCKHEADERVTABLE_HPP
 
 
+#include <type_traits>
 #include "GCIBlockHeaderVTable.hpp"
 
 
 /**
  * Class that allows the customization of the individual functions of a block header vtable.
- * @param Scan type of the scan function.
+ * @param Scan type of the scan function; it receives the object memory and the tracer to visit the pointers with,
+ *  or only the object memory, if it does not trace pointers.
  * @param Finalize type of the finalize function.
  * @param Free type of the free function.
  * @param Shared type of the shared function.
@@ -33,9 +35,15 @@ public:
      * Scans for member pointers by invoking the scan function.
      * @param start memory start.
      * @param end memory end.
+     * @param tracer tracer to visit the pointers with.
      */
-    void scan(void* start, void* end) noexcept final {
-        m_scan(start);
+    void scan(void* start, void* end, GCTracer& tracer) noexcept final {
+        if constexpr (std::is_invocable_v<Scan&, void*, GCTracer&>) {
+            m_scan(start, tracer);
+        }
+        else {
+            m_scan(start);
+        }
     }
 
     /**
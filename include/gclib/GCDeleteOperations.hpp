@@ -2,6 +2,9 @@
 #define GCLIB_GCDELETEOPERATIONS_HPP
 
 
+#include <cstddef>
+
+
 template <class T> class GCPtr;
 
 
@@ -11,6 +14,9 @@ private:
     //unregisters a block
     static void unregisterBlock(class GCBlockHeader* block);
 
+    //removes a block from the index of blocks and frees its memory
+    static void freeBlock(class GCBlockHeader* block);
+
     //delete a block without unregistering it
     static void deleteBlock(class GCBlockHeader* block);
 
@@ -32,8 +38,8 @@ private:
     //global delete function uses the function 'gcdelete'
     template <class T> friend void gcdelete(GCPtr<T>&& ptr);
 
-    //internal function
-    friend static void sweep(class GCBlockHeader* block);
+    //the sweeper deletes unreachable blocks
+    friend class GCSweeper;
 };
 
 
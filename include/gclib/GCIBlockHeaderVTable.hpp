@@ -2,17 +2,115 @@
 #define GCLIB_GCIBLOCKHEADERVTABLE_HPP
 
 
+#include <cstdint>
+#include "GCTypeDescriptor.hpp"
+
+
 /**
  * VTable interface for block headers. 
+ * Each vtable registers a type descriptor to the collector on construction and receives its type id,
+ * so as that block headers refer to their vtable by index rather than by pointer.
+ * The collector invokes the vtable functions via the descriptor, unless subclasses provide direct function pointers.
  */
 class GCIBlockHeaderVTable {
 public:
+    ///trait: the objects have trivial destructors, and therefore they need not be finalized.
+    static constexpr uint8_t TriviallyDestructible = 1;
+
+    ///trait: the objects do not contain gc pointers, and therefore their pointers need not be reset before finalization.
+    static constexpr uint8_t NoPtrs = 2;
+
+    ///trait: the objects cannot be shared via shared pointers, and therefore they need not be checked for being shared.
+    static constexpr uint8_t NotShareable = 4;
+
+    ///trait: the memory is allocated by the collector's default allocator, i.e. from the arena of the allocating thread.
+    static constexpr uint8_t DefaultAllocator = 8;
+
+    ///trait: the objects might contain gc pointers, but the scan function does nothing, i.e. the gc pointers are only those of the block's pointer list.
+    static constexpr uint8_t NoScan = 16;
+
+    ///trait: the objects contain gc pointers at the offsets of the vtable's pointer layout, which the marker scans directly.
+    static constexpr uint8_t Traced = 32;
+
+    ///unreachable blocks with all these traits are freed in bulk, without any call to the vtable.
+    static constexpr uint8_t Trivial = TriviallyDestructible | NoPtrs | NotShareable | DefaultAllocator;
+
+    /**
+     * Registers the vtable.
+     * @param traits compile-time traits of the objects managed by the vtable; 
+     *  they allow the collector to skip the respective vtable functions.
+     * @param layout layout of the gc pointers of the objects; used if the traits include Traced.
+     * @exception std::runtime_error thrown if too many vtables are registered.
+     */
+    GCIBlockHeaderVTable(uint8_t traits = 0, const GCPtrLayout& layout = GCPtrLayout());
+
+    /**
+     * Registers the vtable; the copy receives its own index.
+     * @exception std::runtime_error thrown if too many vtables are registered.
+     */
+    GCIBlockHeaderVTable(const GCIBlockHeaderVTable&);
+
+    /**
+     * Registers the vtable with the given descriptor; the function pointers of the descriptor 
+     * are invoked directly, while the null ones are invoked via this vtable.
+     * @param descriptor the type descriptor.
+     * @exception std::runtime_error thrown if too many vtables are registered.
+     */
+    GCIBlockHeaderVTable(const GCTypeDescriptor& descriptor);
+
+    /**
+     * Unregisters the vtable.
+     * The vtable must outlive the blocks allocated with it, since its type id is reused after it is unregistered.
+     */
+    virtual ~GCIBlockHeaderVTable();
+
+    /**
+     * Keeps the index of this vtable.
+     * @return reference to this.
+     */
+    GCIBlockHeaderVTable& operator = (const GCIBlockHeaderVTable&) noexcept {
+        return *this;
+    }
+
+    /**
+     * Returns the index of this vtable.
+     * @return the index of this vtable.
+     */
+    uint16_t getIndex() const noexcept {
+        return m_index;
+    }
+
+    /**
+     * Returns the traits of the objects managed by this vtable.
+     * @return the traits of the objects managed by this vtable.
+     */
+    uint8_t getTraits() const noexcept {
+        return m_descriptor.traits;
+    }
+
+    /**
+     * Returns the layout of the gc pointers of the objects managed by this vtable.
+     * @return the layout of the gc pointers of the objects managed by this vtable.
+     */
+    const GCPtrLayout& getLayout() const noexcept {
+        return m_descriptor.layout;
+    }
+
+    /**
+     * Returns the type descriptor of this vtable.
+     * @return the type descriptor of this vtable.
+     */
+    const GCTypeDescriptor& getDescriptor() const noexcept {
+        return m_descriptor;
+    }
+
     /**
      * Scan for pointers interface.
      * @param start memory start.
      * @param end memory end.
+     * @param tracer tracer to visit the pointers with.
      */
-    virtual void scan(void* start, void* end) noexcept = 0;
+    virtual void scan(void* start, void* end, GCTracer& tracer) noexcept = 0;
 
     /**
      * Finalize interface.
@@ -35,7 +133,37 @@ public:
      * @return true if objects have shared pointers to them, false otherwise.
      */
     virtual bool shared(void* start, void* end) const noexcept = 0;
+
+private:
+    //type descriptor of this vtable; it refers back to this vtable
+    GCTypeDescriptor m_descriptor;
+
+    //index of this vtable
+    uint16_t m_index;
 };
 
 
+//the descriptor functions are defined here, since they fall back to the vtable interface
+
+
+inline void GCTypeDescriptor::scan(void* start, void* end, GCTracer& tracer) const noexcept {
+    scanFunction ? scanFunction(start, end, tracer) : vtable->scan(start, end, tracer);
+}
+
+
+inline void GCTypeDescriptor::finalize(void* start, void* end) const noexcept {
+    finalizeFunction ? finalizeFunction(start, end) : vtable->finalize(start, end);
+}
+
+
+inline void GCTypeDescriptor::free(void* mem) const noexcept {
+    freeFunction ? freeFunction(mem) : vtable->free(mem);
+}
+
+
+inline bool GCTypeDescriptor::shared(void* start, void* end) const noexcept {
+    return sharedFunction ? sharedFunction(start, end) : vtable->shared(start, end);
+}
+
+
 #endif //GCLIB_GCIBLOCKHEADERVTABLE_HPP
@@ -2,6 +2,9 @@
 #define GCLIB_GCISCANNABLEOBJECT_HPP
 
 
+#include "GCTracer.hpp"
+
+
 /**
  * Interface for objects that are manually scanned. 
  */
@@ -9,10 +12,11 @@ class GCIScannableObject {
 public:
     /**
      * The scan function.
-     * Subclasses must provide the code to manually scan the object for pointers.
+     * Subclasses must provide the code to manually scan the object for pointers,
+     * by passing the pointers to the given tracer (e.g. via GCBasicPtr::scan).
+     * @param tracer tracer of the thread that scans the object.
      */
-    virtual void scan() const noexcept = 0 {
-    }
+    virtual void scan(GCTracer& tracer) const noexcept = 0;
 };
 
 
@@ -0,0 +1,183 @@
+#ifndef GCLIB_GCLOCALPTR_HPP
+#define GCLIB_GCLOCALPTR_HPP
+
+
+#include <atomic>
+#include <stdexcept>
+#include <type_traits>
+#include "GCPtr.hpp"
+
+
+///private GC local ptr functions.
+class GCLocalPtrPrivate {
+private:
+    //pushes a slot to the shadow stack of the current thread
+    static std::atomic<void*>* push(void* value);
+
+    //pops a slot from the shadow stack of the current thread
+    static void pop(std::atomic<void*>* slot);
+
+    //sets the value of a slot, synchronized with the collector
+    static void store(std::atomic<void*>* slot, void* value);
+
+    template <class T> friend class GCLocalPtr;
+};
+
+
+/**
+ * A garbage collected pointer for automatic storage, i.e. for local variables.
+ *
+ * Instead of being linked to a list of pointers, its value is kept in a slot of the shadow stack 
+ * of the current thread; slots are pushed and popped without locking, and the collector
+ * scans the shadow stack as an array.
+ *
+ * Instances must be created and destroyed in the same thread, and they must not be members 
+ * of garbage-collected objects; the class GCPtr shall be used for pointers with non-scoped lifetimes.
+ * Instances that are destroyed out of order (e.g. temporaries) are supported, but their destruction requires locking.
+ *
+ * @param T type of value to point to.
+ */
+template <class T> class GCLocalPtr {
+public:
+    /**
+     * The default constructor.
+     * @param value initial value.
+     */
+    GCLocalPtr(T* value = nullptr) : m_slot(GCLocalPtrPrivate::push(value)) {
+    }
+
+    /**
+     * The copy constructor.
+     * @param ptr source object.
+     */
+    GCLocalPtr(const GCLocalPtr& ptr) : m_slot(GCLocalPtrPrivate::push(ptr.get())) {
+    }
+
+    /**
+     * The move constructor.
+     * @param ptr source object; set to null on return.
+     */
+    GCLocalPtr(GCLocalPtr&& ptr) : m_slot(GCLocalPtrPrivate::push(ptr.get())) {
+        GCLocalPtrPrivate::store(ptr.m_slot, nullptr);
+    }
+
+    /**
+     * The copy constructor from subtype.
+     * @param ptr source object.
+     */
+    template <class U, class = std::enable_if_t<std::is_base_of_v<T, U>, int>>
+    GCLocalPtr(const GCLocalPtr<U>& ptr) : m_slot(GCLocalPtrPrivate::push(static_cast<T*>(ptr.get()))) {
+    }
+
+    /**
+     * Constructor from garbage-collected pointer.
+     * @param ptr source object.
+     */
+    template <class U, class = std::enable_if_t<std::is_base_of_v<T, U>, int>>
+    GCLocalPtr(const GCPtr<U>& ptr) : m_slot(GCLocalPtrPrivate::push(static_cast<T*>(ptr.get()))) {
+    }
+
+    /**
+     * The destructor.
+     */
+    ~GCLocalPtr() {
+        GCLocalPtrPrivate::pop(m_slot);
+    }
+
+    /**
+     * Assignment from raw value.
+     * @param value value.
+     * @return reference to this.
+     */
+    GCLocalPtr& operator = (T* value) {
+        GCLocalPtrPrivate::store(m_slot, value);
+        return *this;
+    }
+
+    /**
+     * Copy assignment.
+     * @param ptr source object.
+     * @return reference to this.
+     */
+    GCLocalPtr& operator = (const GCLocalPtr& ptr) {
+        GCLocalPtrPrivate::store(m_slot, ptr.get());
+        return *this;
+    }
+
+    /**
+     * Copy assignment from subtype.
+     * @param ptr source object.
+     * @return reference to this.
+     */
+    template <class U, class = std::enable_if_t<std::is_base_of_v<T, U>, int>>
+    GCLocalPtr& operator = (const GCLocalPtr<U>& ptr) {
+        GCLocalPtrPrivate::store(m_slot, static_cast<T*>(ptr.get()));
+        return *this;
+    }
+
+    /**
+     * Assignment from garbage-collected pointer.
+     * @param ptr source object.
+     * @return reference to this.
+     */
+    template <class U, class = std::enable_if_t<std::is_base_of_v<T, U>, int>>
+    GCLocalPtr& operator = (const GCPtr<U>& ptr) {
+        GCLocalPtrPrivate::store(m_slot, static_cast<T*>(ptr.get()));
+        return *this;
+    }
+
+    /**
+     * Returns the raw pointer value.
+     * @return the raw pointer value.
+     */
+    T* get() const noexcept {
+        return reinterpret_cast<T*>(m_slot->load(std::memory_order_relaxed));
+    }
+
+    /**
+     * Auto conversion to raw pointer value.
+     * @return the raw pointer value.
+     */
+    operator T*() const noexcept {
+        return get();
+    }
+
+    /**
+     * The dereference operator.
+     * @return the raw pointer value.
+     * @exception std::runtime_error thrown if the pointer is null.
+     */
+    T& operator *() const {
+        T* value = get();
+        return value ? *value : throw std::runtime_error("null ptr exception");
+    }
+
+    /**
+     * Member access.
+     * @return the raw pointer value.
+     * @exception std::runtime_error thrown if the pointer is null.
+     */
+    T* operator ->() const {
+        T* value = get();
+        return value ? value : throw std::runtime_error("null ptr exception");
+    }
+
+    /**
+     * Sets this pointer to null.
+     * @return previous pointer value.
+     */
+    T* reset() {
+        T* result = get();
+        operator = (nullptr);
+        return result;
+    }
+
+private:
+    //slot of the shadow stack that holds the value
+    std::atomic<void*>* m_slot;
+
+    template <class U> friend class GCLocalPtr;
+};
+
+
+#endif //GCLIB_GCLOCALPTR_HPP
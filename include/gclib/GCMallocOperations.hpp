@@ -0,0 +1,26 @@
+#ifndef GCLIB_GCMALLOCOPERATIONS_HPP
+#define GCLIB_GCMALLOCOPERATIONS_HPP
+
+
+#include <cstddef>
+
+
+///class with private algorithms used by the GCMalloc template class.
+class GCMallocOperations {
+private:
+    //allocates memory from the arena or leaf arena of the current thread or, for larger sizes, 
+    //from the system allocator or the large object space
+    static void* malloc(size_t size, bool leaf);
+
+    //frees memory allocated by the function 'malloc'; the memory must start with a block header
+    static void free(void* mem);
+
+    //checks if memory of the given size allocated by the function 'malloc' is zero-filled;
+    //large blocks are mapped directly from the system, which provides zero-filled pages
+    static bool isZeroed(size_t size);
+
+    template <class T> friend struct GCMalloc;
+};
+
+
+#endif //GCLIB_GCMALLOCOPERATIONS_HPP
@@ -12,18 +12,27 @@ template <class T> struct GCList;
 ///class with private algorithms used by the gcnew template function.
 class GCNewOperations {
 private:
+    //sweeps a few of the blocks queued for lazy sweeping
+    static void sweepQueuedBlocks();
+
     //if the allocation limit is exceeded, then collect garbage
     static void collectGarbageIfAllocationLimitIsExceeded();
 
     //returns the block header size
     static size_t getBlockHeaderSize();
 
+    //returns the maximum block size, including the header
+    static size_t getMaxBlockSize();
+
     //register gc memory; returns pointer to object memory
-    static void* registerAllocation(size_t size, void* mem, GCIBlockHeaderVTable& vtable, GCList<GCPtrStruct>*& prevPtrList);
+    static void* registerAllocation(size_t size, void* mem, uint16_t typeId, GCList<GCPtrStruct>*& prevPtrList);
 
     //sets the current pointer list
     static void setPtrList(GCList<GCPtrStruct>* ptrList);
 
+    //ends the construction of the objects of a block allocated with registerAllocation; restores the previous pointer list
+    static void endConstruction(void* mem, GCList<GCPtrStruct>* prevPtrList);
+
     template <class T, class Malloc, class Init, class VTable> friend GCPtr<T> gcnew(size_t, Malloc&&, Init&&, VTable&);
     template <class T> friend void gcdelete(const GCPtr<T>&);
 };
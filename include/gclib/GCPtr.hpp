@@ -2,6 +2,7 @@
 #define GCLIB_GCPTR_HPP
 
 
+#include <memory>
 #include <type_traits>
 #include "GCPtrStruct.hpp"
 #include "GCPtrOperations.hpp"
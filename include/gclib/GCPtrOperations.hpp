@@ -12,11 +12,21 @@ class GCPtrOperations {
 public:
     /**
      * Helper function used for scanning a pointer.
-     * Invoked during the mark phase.
+     * Invoked during the mark phase, from the thread that marks; scan functions shall prefer the tracer they receive.
      * @param value pointer value.
      */
     static void scan(void* value);
 
+    /**
+     * Helper function used for storing a pointer value; it must be invoked within a GCThreadLock.
+     * While blocks are marked concurrently, it records the overwritten value, so as that the blocks 
+     * reachable when marking started are marked; in generational mode, it marks dirty the card that contains the pointer,
+     * so as that young collections scan the old blocks that might point to young blocks.
+     * @param dst destination pointer.
+     * @param value value to store.
+     */
+    static void store(void*& dst, void* value);
+
     /**
      * Function that allows copying a pointer synchronized with the collector.
      * @param dst destination pointer.
@@ -24,7 +34,8 @@ public:
      */
     template <class Dst, class Src> static void copy(Dst*& dst, Src* src) {
         GCThreadLock lock;
-        dst = src;
+        Dst* value = src;
+        store(reinterpret_cast<void*&>(dst), const_cast<void*>(static_cast<const void*>(value)));
     }
 
     /**
@@ -34,9 +45,9 @@ public:
      */
     template <class Dst, class Src> static void move(Dst*& dst, Src*& src) {
         GCThreadLock lock;
-        Src* temp = src;
-        src = nullptr;
-        dst = temp;
+        Dst* value = src;
+        store(reinterpret_cast<void*&>(src), nullptr);
+        store(reinterpret_cast<void*&>(dst), const_cast<void*>(static_cast<const void*>(value)));
     }
 };
 
@@ -13,8 +13,8 @@ struct GCPtrStruct : GCNode<GCPtrStruct> {
     ///the pointer value.
     void* value;
 
-    ///the mutex this pointer shall lock in order to copy/move values, register/unregister itself to/from the collector.
-    std::recursive_mutex* mutex;
+    ///the mutex this pointer shall lock in order to register/unregister itself to/from the collector.
+    std::mutex* mutex;
 };
 
 
@@ -5,6 +5,11 @@
 /**
  * Class that stops the collector from processing the data of the given thread.
  * It will block collection until it goes out of scope.
+ *
+ * It does not lock a mutex: the thread announces that it is in a region in which the collector must not run,
+ * and, if the collector has requested the threads to stop, it waits for the collector to finish;
+ * the collector, in turn, waits for the threads that are in a region to leave it.
+ * Regions can be nested.
  */
 class GCThreadLock {
 public:
@@ -0,0 +1,78 @@
+#ifndef GCLIB_GCTRACE_HPP
+#define GCLIB_GCTRACE_HPP
+
+
+#include <cstddef>
+#include <array>
+
+
+/**
+ * Compile-time layout of the gc pointers of a type.
+ * The primary template declares no pointers; the macro GC_TRACE specializes it for a type,
+ * so as that the marker reads the pointers of its objects directly from the declared offsets.
+ * @param T type of object.
+ */
+template <class T> struct GCTrace {
+    ///offsets of the gc pointers within an object of type T.
+    static constexpr std::array<size_t, 0> Offsets{};
+};
+
+
+/**
+ * Runtime view of the layout of the gc pointers of a type; kept by the vtable of its blocks.
+ */
+struct GCPtrLayout {
+    ///offsets of the gc pointers within an object.
+    const size_t* offsets{ nullptr };
+
+    ///number of gc pointers of an object.
+    size_t count{ 0 };
+
+    ///size of an object; the objects of arrays are scanned one after the other.
+    size_t stride{ 0 };
+};
+
+
+//helper macros for GC_TRACE; the extra expansions are required by the traditional MSVC preprocessor
+#define GCLIB_TRACE_EXPAND(X) X
+#define GCLIB_TRACE_CONCAT_(A, B) A##B
+#define GCLIB_TRACE_CONCAT(A, B) GCLIB_TRACE_CONCAT_(A, B)
+#define GCLIB_TRACE_COUNT_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, N, ...) N
+#define GCLIB_TRACE_COUNT(...) GCLIB_TRACE_EXPAND(GCLIB_TRACE_COUNT_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1))
+#define GCLIB_TRACE_OFFSETS_1(T, F) offsetof(T, F)
+#define GCLIB_TRACE_OFFSETS_2(T, F, ...) offsetof(T, F), GCLIB_TRACE_EXPAND(GCLIB_TRACE_OFFSETS_1(T, __VA_ARGS__))
+#define GCLIB_TRACE_OFFSETS_3(T, F, ...) offsetof(T, F), GCLIB_TRACE_EXPAND(GCLIB_TRACE_OFFSETS_2(T, __VA_ARGS__))
+#define GCLIB_TRACE_OFFSETS_4(T, F, ...) offsetof(T, F), GCLIB_TRACE_EXPAND(GCLIB_TRACE_OFFSETS_3(T, __VA_ARGS__))
+#define GCLIB_TRACE_OFFSETS_5(T, F, ...) offsetof(T, F), GCLIB_TRACE_EXPAND(GCLIB_TRACE_OFFSETS_4(T, __VA_ARGS__))
+#define GCLIB_TRACE_OFFSETS_6(T, F, ...) offsetof(T, F), GCLIB_TRACE_EXPAND(GCLIB_TRACE_OFFSETS_5(T, __VA_ARGS__))
+#define GCLIB_TRACE_OFFSETS_7(T, F, ...) offsetof(T, F), GCLIB_TRACE_EXPAND(GCLIB_TRACE_OFFSETS_6(T, __VA_ARGS__))
+#define GCLIB_TRACE_OFFSETS_8(T, F, ...) offsetof(T, F), GCLIB_TRACE_EXPAND(GCLIB_TRACE_OFFSETS_7(T, __VA_ARGS__))
+#define GCLIB_TRACE_OFFSETS_9(T, F, ...) offsetof(T, F), GCLIB_TRACE_EXPAND(GCLIB_TRACE_OFFSETS_8(T, __VA_ARGS__))
+#define GCLIB_TRACE_OFFSETS_10(T, F, ...) offsetof(T, F), GCLIB_TRACE_EXPAND(GCLIB_TRACE_OFFSETS_9(T, __VA_ARGS__))
+#define GCLIB_TRACE_OFFSETS_11(T, F, ...) offsetof(T, F), GCLIB_TRACE_EXPAND(GCLIB_TRACE_OFFSETS_10(T, __VA_ARGS__))
+#define GCLIB_TRACE_OFFSETS_12(T, F, ...) offsetof(T, F), GCLIB_TRACE_EXPAND(GCLIB_TRACE_OFFSETS_11(T, __VA_ARGS__))
+#define GCLIB_TRACE_OFFSETS_13(T, F, ...) offsetof(T, F), GCLIB_TRACE_EXPAND(GCLIB_TRACE_OFFSETS_12(T, __VA_ARGS__))
+#define GCLIB_TRACE_OFFSETS_14(T, F, ...) offsetof(T, F), GCLIB_TRACE_EXPAND(GCLIB_TRACE_OFFSETS_13(T, __VA_ARGS__))
+#define GCLIB_TRACE_OFFSETS_15(T, F, ...) offsetof(T, F), GCLIB_TRACE_EXPAND(GCLIB_TRACE_OFFSETS_14(T, __VA_ARGS__))
+#define GCLIB_TRACE_OFFSETS_16(T, F, ...) offsetof(T, F), GCLIB_TRACE_EXPAND(GCLIB_TRACE_OFFSETS_15(T, __VA_ARGS__))
+
+
+/**
+ * Declares the gc pointer members of a type, so as that they are traced without being registered to the collector.
+ * The members must be of type GCBasicPtr (or of any other type with the layout of a raw pointer
+ * that modifies its value via GCPtrOperations); they are found by the marker at the declared offsets,
+ * and therefore they need not be fat pointers, nor scanned manually via GCIScannableObject.
+ * The type must have a standard layout, and up to 16 members can be declared.
+ * It must be used at global scope, after the definition of the type, and before the first allocation of the type.
+ * @param TYPE type of object.
+ * @param ... names of the gc pointer members.
+ */
+#define GC_TRACE(TYPE, ...)\
+    template <> struct GCTrace<TYPE> {\
+        static constexpr std::array<size_t, GCLIB_TRACE_COUNT(__VA_ARGS__)> Offsets{{\
+            GCLIB_TRACE_EXPAND(GCLIB_TRACE_CONCAT(GCLIB_TRACE_OFFSETS_, GCLIB_TRACE_COUNT(__VA_ARGS__))(TYPE, __VA_ARGS__))\
+        }};\
+    }
+
+
+#endif //GCLIB_GCTRACE_HPP
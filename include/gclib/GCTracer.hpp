@@ -0,0 +1,47 @@
+#ifndef GCLIB_GCTRACER_HPP
+#define GCLIB_GCTRACER_HPP
+
+
+#include <cstddef>
+
+
+class GCMarker;
+
+
+/**
+ * Visitor passed to the scan functions of manually traced objects.
+ * It carries the marking context of the thread that scans the object,
+ * and therefore manual tracing works with any number of marker threads.
+ * Pointers can be visited one by one, or in batches, which the marker filters at once.
+ */
+class GCTracer {
+public:
+    GCTracer(const GCTracer&) = delete;
+    GCTracer& operator = (const GCTracer&) = delete;
+
+    /**
+     * Marks the block a pointer points to, if any.
+     * @param value pointer value.
+     */
+    void visit(const void* value) noexcept;
+
+    /**
+     * Marks the blocks an array of pointers point to.
+     * @param values pointer values; they can also be the values of an array of GCBasicPtr, which has the layout of raw pointers.
+     * @param count number of pointer values.
+     */
+    void visit(const void* const* values, size_t count) noexcept;
+
+private:
+    //the marker of the thread that scans
+    GCMarker& m_marker;
+
+    //constructor
+    GCTracer(GCMarker& marker) noexcept : m_marker(marker) {
+    }
+
+    friend class GCMarker;
+};
+
+
+#endif //GCLIB_GCTRACER_HPP
@@ -0,0 +1,114 @@
+#ifndef GCLIB_GCTYPEDESCRIPTOR_HPP
+#define GCLIB_GCTYPEDESCRIPTOR_HPP
+
+
+#include <cstdint>
+#include "GCTrace.hpp"
+#include "GCTracer.hpp"
+
+
+class GCIBlockHeaderVTable;
+
+
+/**
+ * Descriptor of the objects of a block.
+ * Block headers refer to their descriptor by type id, and the collector branches on the traits
+ * before invoking any function, so as that it skips the calls the objects do not need.
+ * The descriptors of types allocated by gcnew are constant expressions with direct function pointers;
+ * the descriptors of custom vtables have no function pointers, and their functions are invoked via the vtable.
+ */
+struct GCTypeDescriptor {
+    ///traits of the objects; see GCIBlockHeaderVTable.
+    uint8_t traits{ 0 };
+
+    ///layout of the gc pointers of the objects; used if the traits include GCIBlockHeaderVTable::Traced.
+    GCPtrLayout layout;
+
+    ///scans the objects for pointers; null if the objects are not scanned.
+    void (*scanFunction)(void* start, void* end, GCTracer& tracer) noexcept { nullptr };
+
+    ///finalizes the objects; null if the objects are trivially destructible.
+    void (*finalizeFunction)(void* start, void* end) noexcept { nullptr };
+
+    ///frees the memory of the block.
+    void (*freeFunction)(void* mem) noexcept { nullptr };
+
+    ///checks if the objects are shared by shared pointers; null if the objects cannot be shared.
+    bool (*sharedFunction)(void* start, void* end) noexcept { nullptr };
+
+    ///vtable whose functions are invoked for the function pointers that are null; null for types allocated by gcnew.
+    GCIBlockHeaderVTable* vtable{ nullptr };
+
+    /**
+     * Scans the objects for pointers.
+     * @param start memory start.
+     * @param end memory end.
+     * @param tracer tracer to visit the pointers with.
+     */
+    void scan(void* start, void* end, GCTracer& tracer) const noexcept;
+
+    /**
+     * Finalizes the objects.
+     * @param start memory start.
+     * @param end memory end.
+     */
+    void finalize(void* start, void* end) const noexcept;
+
+    /**
+     * Frees the memory of the block.
+     * @param mem pointer to memory to free.
+     */
+    void free(void* mem) const noexcept;
+
+    /**
+     * Checks if the objects are shared by shared pointers.
+     * @param start start of memory block.
+     * @param end end of memory block.
+     * @return true if objects have shared pointers to them, false otherwise.
+     */
+    bool shared(void* start, void* end) const noexcept;
+};
+
+
+///private type id functions.
+class GCTypeIdPrivate {
+private:
+    //registers a type descriptor; returns the type id
+    static uint16_t insert(const GCTypeDescriptor& descriptor);
+
+    template <const GCTypeDescriptor& Descriptor> friend class GCTypeId;
+};
+
+
+/**
+ * Type id of a constant type descriptor.
+ * The descriptor is registered during static initialization, and therefore the type id is read without synchronization;
+ * if the type id is requested before its own initialization (i.e. from another static initializer),
+ * the descriptor is registered on demand.
+ * @param Descriptor the type descriptor.
+ */
+template <const GCTypeDescriptor& Descriptor> class GCTypeId {
+public:
+    /**
+     * Returns the type id.
+     * @return the type id.
+     * @exception std::runtime_error thrown if too many types are registered.
+     */
+    static uint16_t getIndex() {
+        const uint16_t index = m_index;
+        return index ? index : getIndexOnDemand();
+    }
+
+private:
+    //the type id; zero until initialized
+    static inline const uint16_t m_index = GCTypeIdPrivate::insert(Descriptor);
+
+    //registers the descriptor if requested before the initialization of the type id
+    static uint16_t getIndexOnDemand() {
+        static const uint16_t index = GCTypeIdPrivate::insert(Descriptor);
+        return index;
+    }
+};
+
+
+#endif //GCLIB_GCTYPEDESCRIPTOR_HPP
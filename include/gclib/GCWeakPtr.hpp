@@ -0,0 +1,135 @@
+#ifndef GCLIB_GCWEAKPTR_HPP
+#define GCLIB_GCWEAKPTR_HPP
+
+
+#include <type_traits>
+#include "GCWeakPtrStruct.hpp"
+#include "GCPtr.hpp"
+
+
+///private GC weak ptr functions.
+class GCWeakPtrPrivate {
+private:
+    //init ptr, register it to the collector
+    static void init(GCWeakPtrStruct* ptr, void* value);
+
+    //init ptr, copy the value of another weak ptr
+    static void initCopy(GCWeakPtrStruct* ptr, const GCWeakPtrStruct* src);
+
+    //copy the value of another weak ptr
+    static void copy(GCWeakPtrStruct* ptr, const GCWeakPtrStruct* src);
+
+    //returns the value, made reachable for the collection in progress, if any; must be invoked within a region
+    static void* lock(const GCWeakPtrStruct* ptr);
+
+    //remove ptr from collector
+    static void cleanup(GCWeakPtrStruct* ptr);
+
+    template <class T> friend class GCWeakPtr;
+};
+
+
+/**
+ * A garbage collected weak pointer.
+ * It is not scanned by the collector, and therefore it does not keep the object it points to alive;
+ * when the object is found unreachable, the collector sets the pointer to null, before the object is finalized.
+ * Caches of garbage collected objects can keep weak pointers to them, so as that they shrink at each collection.
+ *
+ * The object is accessed via a GCPtr returned by lock(), which can be invoked from any thread;
+ * an object that is being marked at the time is made reachable by the GCPtr, and the weak pointer is not cleared.
+ * The value of a weak pointer can be modified while other threads lock it.
+ *
+ * @param T type of value to point to.
+ */
+template <class T> class GCWeakPtr : private GCWeakPtrStruct {
+public:
+    /**
+     * The default constructor.
+     * @param value initial value; it must point to a reachable object, or be null.
+     */
+    GCWeakPtr(T* value = nullptr) {
+        GCWeakPtrPrivate::init(this, value);
+    }
+
+    /**
+     * Constructor from GC ptr.
+     * @param ptr source object.
+     */
+    template <class U, class = std::enable_if_t<std::is_base_of_v<T, U>, int>>
+    GCWeakPtr(const GCPtr<U>& ptr) {
+        GCWeakPtrPrivate::init(this, static_cast<T*>(ptr.get()));
+    }
+
+    /**
+     * The copy constructor.
+     * @param ptr source object.
+     */
+    GCWeakPtr(const GCWeakPtr& ptr) {
+        GCWeakPtrPrivate::initCopy(this, &ptr);
+    }
+
+    /**
+     * The destructor.
+     */
+    ~GCWeakPtr() {
+        GCWeakPtrPrivate::cleanup(this);
+    }
+
+    /**
+     * Assignment from raw value.
+     * @param value value; it must point to a reachable object, or be null.
+     * @return reference to this.
+     */
+    GCWeakPtr& operator = (T* value) {
+        this->value.store(value, std::memory_order_release);
+        return *this;
+    }
+
+    /**
+     * Assignment from GC ptr.
+     * @param ptr source object.
+     * @return reference to this.
+     */
+    template <class U, class = std::enable_if_t<std::is_base_of_v<T, U>, int>>
+    GCWeakPtr& operator = (const GCPtr<U>& ptr) {
+        value.store(static_cast<T*>(ptr.get()), std::memory_order_release);
+        return *this;
+    }
+
+    /**
+     * Copy assignment.
+     * @param ptr source object.
+     * @return reference to this.
+     */
+    GCWeakPtr& operator = (const GCWeakPtr& ptr) {
+        GCWeakPtrPrivate::copy(this, &ptr);
+        return *this;
+    }
+
+    /**
+     * Returns a GC ptr to the object, which keeps it alive.
+     * @return a GC ptr to the object, or a null GC ptr if the object was collected.
+     */
+    GCPtr<T> lock() const {
+        GCThreadLock region;
+        return GCPtr<T>(reinterpret_cast<T*>(GCWeakPtrPrivate::lock(this)));
+    }
+
+    /**
+     * Checks if the pointer is null, i.e. if the object was collected.
+     * @return true if the pointer is null, false otherwise.
+     */
+    bool expired() const noexcept {
+        return value.load(std::memory_order_acquire) == nullptr;
+    }
+
+    /**
+     * Sets this pointer to null.
+     */
+    void reset() noexcept {
+        value.store(nullptr, std::memory_order_release);
+    }
+};
+
+
+#endif //GCLIB_GCWEAKPTR_HPP
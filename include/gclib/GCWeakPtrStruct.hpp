@@ -0,0 +1,18 @@
+#ifndef GCLIB_GCWEAKPTRSTRUCT_HPP
+#define GCLIB_GCWEAKPTRSTRUCT_HPP
+
+
+#include <atomic>
+#include "GCNode.hpp"
+
+
+/**
+ * Internal struct that represents a weak pointer.
+ */
+struct GCWeakPtrStruct : GCNode<GCWeakPtrStruct> {
+    ///the pointer value; the collector clears it when the block it points to is found unreachable.
+    std::atomic<void*> value;
+};
+
+
+#endif //GCLIB_GCWEAKPTRSTRUCT_HPP
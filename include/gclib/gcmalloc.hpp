@@ -4,6 +4,7 @@
 
 #include <cstddef>
 #include "gctraits.hpp"
+#include "GCMallocOperations.hpp"
 
 
 /**
@@ -13,23 +14,25 @@
 template <class T> struct GCMalloc {
     /**
      * Allocates memory for type T.
-     * It statically selects T::operator new if it exists, otherwise it uses ::operator new.
+     * It statically selects T::operator new if it exists, otherwise it uses the arena of the current thread.
      * @param size number of objects to allocate.
+     * @param leaf if true, the memory is allocated from the leaf arena of the current thread,
+     *  which holds only objects without gc pointers.
      * @return pointer to allocated memory.
      */
-    static void* malloc(size_t size) {
+    static void* malloc(size_t size, bool leaf = false) {
         if constexpr (GCHasOperatorNew<T>::Value) {
             static_assert(GCHasOperatorDelete<T>::Value, "class has operator new but not operator delete");
             return T::operator new(size);
         }
         else {
-            return ::operator new(size);
+            return GCMallocOperations::malloc(size, leaf);
         }
     }
 
     /**
      * Frees memory for type T. 
-     * It statically selects T::operator delete if it exists, otherwise it uses ::operator delete.
+     * It statically selects T::operator delete if it exists, otherwise it returns the memory to its arena.
      * @param mem pointer to memory start to free, as returned by malloc.
      */
     static void free(void* mem) {
@@ -37,7 +40,7 @@ template <class T> struct GCMalloc {
             T::operator delete(mem);
         }
         else {
-            ::operator delete(mem);
+            GCMallocOperations::free(mem);
         }
     }
 };
@@ -50,23 +53,25 @@ template <class T> struct GCMalloc {
 template <class T> struct GCMalloc<T[]> {
     /**
      * Allocates memory for type T.
-     * It statically selects T::operator new[] if it exists, otherwise it uses ::operator new[].
+     * It statically selects T::operator new[] if it exists, otherwise it uses the arena of the current thread.
      * @param size number of objects to allocate.
+     * @param leaf if true, the memory is allocated from the leaf arena of the current thread,
+     *  which holds only objects without gc pointers.
      * @return pointer to allocated memory.
      */
-    static void* malloc(size_t size) {
+    static void* malloc(size_t size, bool leaf = false) {
         if constexpr (GCHasOperatorNew<T[]>::Value) {
             static_assert(GCHasOperatorDelete<T[]>::Value, "class has operator new[] but not operator delete[]");
             return T::operator new[](size);
         }
         else {
-            return ::operator new[](size);
+            return GCMallocOperations::malloc(size, leaf);
         }
     }
 
     /**
      * Frees memory for type T. 
-     * It statically selects T::operator delete[] if it exists, otherwise it uses ::operator delete[].
+     * It statically selects T::operator delete[] if it exists, otherwise it returns the memory to its arena.
      * @param mem pointer to memory start to free, as returned by malloc.
      */
     static void free(void* mem) {
@@ -74,7 +79,22 @@ template <class T> struct GCMalloc<T[]> {
             T::operator delete[](mem);
         }
         else {
-            ::operator delete[](mem);
+            GCMallocOperations::free(mem);
+        }
+    }
+
+    /**
+     * Checks if memory allocated by malloc is zero-filled,
+     * so as that objects which are zero when value-initialized need not be initialized.
+     * @param size number of bytes allocated, as passed to malloc; a smaller number gives a conservative result.
+     * @return true if the memory is known to be zero-filled, false otherwise.
+     */
+    static bool isZeroed(size_t size) {
+        if constexpr (GCHasOperatorNew<T[]>::Value) {
+            return false;
+        }
+        else {
+            return GCMallocOperations::isZeroed(size);
         }
     }
 };
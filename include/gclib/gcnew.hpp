@@ -17,13 +17,18 @@
  * @param size number of bytes to allocate.
  * @param malloc function to use for allocating memory.
  * @param init function to use for initializing objects.
- * @param vtable reference to vtable that is used to scan/finalize/free memory.
+ * @param vtable reference to vtable that is used to scan/finalize/free memory, or to the type id of a type descriptor;
+ *  its getIndex function returns the type id the block header refers to.
  * @return garbage-collected pointer to object.
- * @exception GCBadAlloc thrown if malloc returns null.
+ * @exception GCBadAlloc thrown if malloc returns null or if the size exceeds the maximum block size.
  * @exception other thrown from object construction.
  */
 template <class T, class Malloc, class Init, class VTable> GCPtr<T> gcnew(size_t size, Malloc&& malloc, Init&& init, VTable& vtable) {
 
+    //before any allocation, sweep some of the blocks left by lazy sweeping,
+    //so as that the cost of sweeping is spread over allocations
+    GCNewOperations::sweepQueuedBlocks();
+
     //before any allocation, check if the allocation limit is exceeded; if so, then collect garbage
     GCNewOperations::collectGarbageIfAllocationLimitIsExceeded();
 
@@ -34,6 +39,11 @@ template <class T, class Malloc, class Init, class VTable> GCPtr<T> gcnew(size_t
     //previous pointer list is stored here
     GCList<GCPtrStruct>* prevPtrList;
 
+    //the block size must fit in the block header
+    if (size > GCNewOperations::getMaxBlockSize() - GCNewOperations::getBlockHeaderSize()) {
+        throw GCBadAlloc();
+    }
+
     //include the block header in the allocation
     size += GCNewOperations::getBlockHeaderSize();
 
@@ -46,12 +56,12 @@ template <class T, class Malloc, class Init, class VTable> GCPtr<T> gcnew(size_t
     }
 
     //register allocation
-    void* objectMem = GCNewOperations::registerAllocation(size, allocMem, vtable, prevPtrList);
+    void* objectMem = GCNewOperations::registerAllocation(size, allocMem, vtable.getIndex(), prevPtrList);
 
     //initialize the objects
     try {
         T* result = init(objectMem);
-        GCNewOperations::setPtrList(prevPtrList);
+        GCNewOperations::endConstruction(allocMem, prevPtrList);
         return result;
     }
 
@@ -59,7 +69,7 @@ template <class T, class Malloc, class Init, class VTable> GCPtr<T> gcnew(size_t
     catch (...) {
         GCNewOperations::setPtrList(prevPtrList);
         GCDeleteOperations::unregisterBlock((class GCBlockHeader*)allocMem);
-        vtable.free(allocMem);
+        GCDeleteOperations::freeBlock((class GCBlockHeader*)allocMem);
         throw;
     }
 
@@ -76,14 +86,14 @@ template <class T, class Malloc, class Init, class VTable> GCPtr<T> gcnew(size_t
  * @exception GCBadAlloc thrown if memory allocation fails.
  */
 template <class T, class... Args> GCPtr<T> gcnew(Args&&... args) {
-    static GCBlockHeaderVTable<T> vtable;
+    GCTypeId<GCBlockHeaderVTable<T>::template Descriptor<>> typeId;
 
     return gcnew<T>(
         sizeof(T), 
 
         //malloc
         [](size_t size) {
-            return GCMalloc<T>::malloc(size);
+            return GCMalloc<T>::malloc(size, GCBlockHeaderVTable<T>::Traits & GCIBlockHeaderVTable::NoPtrs);
         },
         
         //init
@@ -91,8 +101,8 @@ template <class T, class... Args> GCPtr<T> gcnew(Args&&... args) {
             return ::new(mem) T(std::forward<Args>(args)...); 
         },
 
-        //vtable
-        vtable
+        //type id
+        typeId
     );
 }
 
@@ -107,26 +117,106 @@ template <class T, class... Args> GCPtr<T> gcnew(Args&&... args) {
  * @exception GCBadAlloc thrown if memory allocation fails.
  */
 template <class T, class... Args> GCPtr<T> gcnewArray(size_t count, Args&&... args) {
-    static GCBlockHeaderVTable<T[]> vtable;
+    GCTypeId<GCBlockHeaderVTable<T[]>::template Descriptor<>> typeId;
 
     return gcnew<T>(
         count * sizeof(T), 
 
         //malloc
         [](size_t size) {
-            return GCMalloc<T[]>::malloc(size);
+            return GCMalloc<T[]>::malloc(size, GCBlockHeaderVTable<T[]>::Traits & GCIBlockHeaderVTable::NoPtrs);
         },
         
         //init
         [&](void* mem) {
+            //value-initialized trivial objects are all zero bytes; if the memory is already zero-filled
+            //(i.e. large blocks, which are freshly mapped), then the pages need not be touched
+            if constexpr (sizeof...(Args) == 0 && std::is_trivially_default_constructible_v<T>) {
+                if (GCMalloc<T[]>::isZeroed(count * sizeof(T))) {
+                    return reinterpret_cast<T*>(mem);
+                }
+            }
+            for (T *obj = reinterpret_cast<T*>(mem), *end = obj + count; obj < end; ++obj) {
+                ::new(obj) T(std::forward<Args>(args)...);
+            }
+            return reinterpret_cast<T*>(mem);
+        },
+
+        //type id
+        typeId
+    );
+}
+
+
+/**
+ * Allocates a garbage-collected object that does not contain gc pointers (a leaf object).
+ * The object is marked without being scanned, and it is allocated from a separate arena.
+ * Objects of trivially destructible types that do not implement GCIScannableObject are leaf objects
+ * even if allocated with gcnew; this function allows other types, e.g. types with std::string members,
+ * to be declared as leaf objects.
+ * Type T must not contain gc pointers; if it does, the objects they point to might be collected prematurely.
+ * @param args arguments to pass to the object's constructor.
+ * @return pointer to the object.
+ * @exception GCBadAlloc thrown if memory allocation fails.
+ */
+template <class T, class... Args> GCPtr<T> gcnewLeaf(Args&&... args) {
+    GCTypeId<GCBlockHeaderVTable<T>::template Descriptor<GCIBlockHeaderVTable::NoPtrs>> typeId;
+
+    return gcnew<T>(
+        sizeof(T), 
+
+        //malloc
+        [](size_t size) {
+            return GCMalloc<T>::malloc(size, true);
+        },
+        
+        //init
+        [&](void* mem) { 
+            return ::new(mem) T(std::forward<Args>(args)...); 
+        },
+
+        //type id
+        typeId
+    );
+}
+
+
+/**
+ * Allocates a garbage-collected array of objects that do not contain gc pointers (leaf objects).
+ * See gcnewLeaf for details.
+ * @param count number of elements of the array.
+ * @param args arguments to pass to each object's constructor.
+ * @return pointer to the object.
+ * @exception GCBadAlloc thrown if memory allocation fails.
+ */
+template <class T, class... Args> GCPtr<T> gcnewArrayLeaf(size_t count, Args&&... args) {
+    GCTypeId<GCBlockHeaderVTable<T[]>::template Descriptor<GCIBlockHeaderVTable::NoPtrs>> typeId;
+
+    return gcnew<T>(
+        count * sizeof(T), 
+
+        //malloc
+        [](size_t size) {
+            return GCMalloc<T[]>::malloc(size, true);
+        },
+        
+        //init
+        [&](void* mem) {
+            //value-initialized trivial objects are all zero bytes; if the memory is already zero-filled
+            //(i.e. large blocks, which are freshly mapped), then the pages need not be touched
+            if constexpr (sizeof...(Args) == 0 && std::is_trivially_default_constructible_v<T>) {
+                if (GCMalloc<T[]>::isZeroed(count * sizeof(T))) {
+                    return reinterpret_cast<T*>(mem);
+                }
+            }
             for (T *obj = reinterpret_cast<T*>(mem), *end = obj + count; obj < end; ++obj) {
                 ::new(obj) T(std::forward<Args>(args)...);
             }
             return reinterpret_cast<T*>(mem);
         },
 
-        //vtable
-        vtable
+        //type id
+        typeId
     );
 }
 
@@ -1,9 +1,49 @@
+#include <vector>
+#include <thread>
 #include <algorithm>
 #include "gclib/GC.hpp"
 #include "gclib/GCPtrOperations.hpp"
 #include "gclib/GCDeleteOperations.hpp"
 #include "GCCollectorData.hpp"
+#include "GCPtrAccess.hpp"
 #include "GCAsyncCollectionThread.hpp"
+#include "GCLargeObjectSpace.hpp"
+#include "GCPageSource.hpp"
+
+
+//number of times the values recorded by the snapshot barrier are scanned along with the mutators, before the final pause
+static constexpr size_t ConcurrentBarrierPassCount = 4;
+
+
+//requests the threads to stop and waits for them to leave their regions; the global mutex must be locked
+static void suspendThreads(GCCollectorData& collectorData) {
+    //the pause is timed from the stop request
+    collectorData.pauseStart = std::chrono::steady_clock::now();
+
+    //request the threads to stop; threads that enter a region from now on wait for the collector to finish
+    collectorData.stopRequested.store(true, std::memory_order_seq_cst);
+
+    //wait for the threads that are in a region to leave it; the current thread, if it is in a region,
+    //does not run mutator code until collection finishes; thread data of terminated threads are never in a region
+    GCThreadData* currentData = GCThread::currentData();
+    for (GCThreadData* data = collectorData.threads.first(); data != collectorData.threads.end(); data = data->next) {
+        while (data != currentData && data->regionDepth.load(std::memory_order_seq_cst) > 0) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+
+//lets the threads enter regions again
+static void releaseThreads(GCCollectorData& collectorData) {
+    //the pause ends when the threads are let run
+    collectorData.longestPause = std::max(collectorData.longestPause, std::chrono::steady_clock::now() - collectorData.pauseStart);
+    {
+        std::lock_guard lock(collectorData.stopMutex);
+        collectorData.stopRequested.store(false, std::memory_order_release);
+    }
+    collectorData.stopCond.notify_all();
+}
 
 
 //stops all threads that participate in garbage collection
@@ -15,15 +55,7 @@ static bool stopThreads(GCCollectorData& collectorData) {
         return false;
     }
 
-    //lock existing threads
-    for (GCThreadData* data = collectorData.threads.first(); data != collectorData.threads.end(); data = data->next) {
-        data->mutex.lock();
-    }
-
-    //lock thread data of terminated threads; the thread data might be used from existing threads
-    for (GCThreadData* data = collectorData.terminatedThreads.first(); data != collectorData.terminatedThreads.end(); data = data->next) {
-        data->mutex.lock();
-    }
+    suspendThreads(collectorData);
 
     //successfully stopped threads
     return true;
@@ -33,227 +65,467 @@ static bool stopThreads(GCCollectorData& collectorData) {
 //resumes all threads that participate in garbage collection
 static void resumeThreads(GCCollectorData& collectorData) {
 
-    //unlock thread data of terminated threads
-    for (GCThreadData* data = collectorData.terminatedThreads.last(); data != collectorData.terminatedThreads.end(); data = data->prev) {
-        data->mutex.unlock();
-    }
+    //let the threads enter regions again
+    releaseThreads(collectorData);
 
-    //unlock existing threads
-    for (GCThreadData* data = collectorData.threads.last(); data != collectorData.threads.end(); data = data->prev) {
-        data->mutex.unlock();
-    }
+    //publish the longest pause of the collection
+    collectorData.lastPauseDuration.store(std::chrono::duration_cast<std::chrono::microseconds>(collectorData.longestPause).count(), std::memory_order_release);
+    collectorData.longestPause = std::chrono::steady_clock::duration::zero();
 
     //unlock the collectorData so as that new threads can be added during collection
     collectorData.mutex.unlock();
 }
 
 
-//retrieves all blocks from all threads and thread data, then sorts the blocks by address,
-//in order to use binary search for locating blocks
-static void gatherAllBlocks(GCCollectorData& collectorData) {
-
-    //find blocks from threads
+//returns the thread data of active and terminated threads
+static std::vector<GCThreadData*> getThreadData(GCCollectorData& collectorData) {
+    std::vector<GCThreadData*> result;
     for (GCThreadData* data = collectorData.threads.first(); data != collectorData.threads.end(); data = data->next) {
-        for (GCBlockHeader* block = data->blocks.first(); block != data->blocks.end(); block = block->next) {
-            collectorData.blocks.push_back(block);
-        }
+        result.push_back(data);
     }
-
-    //find blocks from thread data
     for (GCThreadData* data = collectorData.terminatedThreads.first(); data != collectorData.terminatedThreads.end(); data = data->next) {
-        for (GCBlockHeader* block = data->blocks.first(); block != data->blocks.end(); block = block->next) {
-            collectorData.blocks.push_back(block);
-        }
+        result.push_back(data);
     }
+    return result;
+}
+
 
-    //sort blocks
-    std::sort(collectorData.blocks.begin(), collectorData.blocks.end());
+//checks if any of the markers overflowed; also resets the overflow flags
+static bool resetMarkerOverflow(GCCollectorData& collectorData) {
+    bool result = false;
+    for (const std::unique_ptr<GCMarker>& marker : collectorData.markers) {
+        result = marker->overflow() || result;
+        marker->resetOverflow();
+    }
+    return result;
 }
 
 
-//finds a block using binary search
-static GCBlockHeader* find(const std::vector<GCBlockHeader*>& blocks, void* addr) {
+//rescans the marked blocks of a block list
+static void rescanMarkedBlocks(GCCollectorData& collectorData, const GCList<GCBlockHeader>& blocks, GCMarker& marker) {
+    for (GCBlockHeader* block = blocks.first(); block != blocks.end(); block = block->next) {
+        if (collectorData.pageMap.isMarked(block, collectorData.cycle)) {
+            marker.scan(block);
+            marker.drain();
+        }
+    }
+}
 
-    //find block with address greater than the given one
-    auto it = std::upper_bound(blocks.begin(), blocks.end(), addr, [](void *addr, GCBlockHeader* block) {
-        return addr < block;
-    });
 
-    //if the result points to the first block, 
-    //it means the address points below the lowest heap object,
-    //and therefore do nothing
-    if (it == blocks.begin()) {
-        return nullptr;
+//rescans the marked blocks of the given thread data;
+//blocks that are marked while rescanning are either scanned via the mark stack or by a later rescan;
+//old blocks are not marked in young collections
+static void rescanMarkedBlocks(GCCollectorData& collectorData, const std::vector<GCThreadData*>& threadData, GCMarker& marker) {
+    for (GCThreadData* data : threadData) {
+        rescanMarkedBlocks(collectorData, data->blocks, marker);
+        if (!collectorData.youngCollection) {
+            rescanMarkedBlocks(collectorData, data->oldBlocks, marker);
+            rescanMarkedBlocks(collectorData, data->oldScannedBlocks, marker);
+        }
     }
+}
 
-    //since the address points to a block lower than the found block,
-    //locate the block from the previous element
-    GCBlockHeader* block = *(it - 1);
 
-    //if the pointer points inside the block,
-    //then return the block
-    if (addr >= block + 1 && addr < block->end) {
-        return block;
+//scans the old blocks of a thread data that might point to young blocks; used in young collections
+static void scanRememberedBlocks(GCThreadData* data, GCMarker& marker) {
+    //old blocks that overlap dirty cards; a card is kept dirty while an old block in it points to young blocks;
+    //free slots have a zero size
+    data->arena->scanCards([&](void* slot) {
+        GCBlockHeader* block = reinterpret_cast<GCBlockHeader*>(slot);
+        return block->size() && block->age == GCBlockHeader::OldAge && marker.scanOld(block);
+    });
+
+    //old blocks without cards
+    for (GCBlockHeader* block = data->oldScannedBlocks.first(); block != data->oldScannedBlocks.end(); block = block->next) {
+        marker.scan(block);
     }
+}
+
 
-    //not found
-    return nullptr;
+//starts a new cycle and clears the mark bitmaps of the arenas, in parallel;
+//it must be completed before marking starts, since a block might be marked by any marker
+static void clearMarks(GCCollectorData& collectorData, const std::vector<GCThreadData*>& threadData) {
+    collectorData.pageMap.beginCollection();
+    ++collectorData.cycle;
+    std::atomic<size_t> nextThreadData{ 0 };
+    collectorData.workers.run([&](size_t) {
+        for (size_t dataIndex; (dataIndex = nextThreadData.fetch_add(1, std::memory_order_relaxed)) < threadData.size();) {
+            threadData[dataIndex]->arena->clearMarks();
+            threadData[dataIndex]->leafArena->clearMarks();
+        }
+    });
 }
 
 
-static void scan(GCCollectorData& collectorData, const GCList<GCPtrStruct>& ptrs);
+//rescans the blocks marked so far until all reachable blocks are scanned; 
+//invoked if some blocks could not be pushed to a mark stack
+static void rescanIfOverflow(GCCollectorData& collectorData, const std::vector<GCThreadData*>& threadData) {
+    GCMarker& marker = *collectorData.markers[0];
+    GCMarker::current = &marker;
+    while (resetMarkerOverflow(collectorData)) {
+        rescanMarkedBlocks(collectorData, threadData, marker);
+    }
+    GCMarker::current = nullptr;
+}
 
 
-//marks a block as reachable
-static void mark(GCCollectorData& collectorData, GCBlockHeader* block) {
+//mark reachable objects
+static void mark(GCCollectorData& collectorData, const std::vector<GCThreadData*>& threadData) {
 
-    //if the block is already marked, do nothing else
-    if (block->cycle == collectorData.cycle) {
-        return;
+    //next cycle; used for marking reachable blocks
+    clearMarks(collectorData, threadData);
+
+    //index of the next thread data to scan the roots of
+    std::atomic<size_t> nextThreadData{ 0 };
+
+    //number of markers that have blocks to scan
+    std::atomic<size_t> activeMarkers{ collectorData.markers.size() };
+
+    //each marker scans the pointers of active/terminated threads it claims,
+    //then it helps the other markers by stealing blocks from them
+    collectorData.workers.run([&](size_t index) {
+        GCMarker& marker = *collectorData.markers[index];
+        GCMarker::current = &marker;
+        for (size_t dataIndex; (dataIndex = nextThreadData.fetch_add(1, std::memory_order_relaxed)) < threadData.size();) {
+            marker.scan(threadData[dataIndex]->ptrs);
+            marker.scan(threadData[dataIndex]->shadowStack);
+            if (collectorData.youngCollection) {
+                scanRememberedBlocks(threadData[dataIndex], marker);
+            }
+            marker.drain();
+        }
+        while (marker.steal(collectorData.markers, activeMarkers)) {
+            marker.drain();
+        }
+        GCMarker::current = nullptr;
+    });
+
+    //if some blocks could not be pushed to a mark stack, 
+    //rescan the marked blocks until all reachable blocks are scanned
+    rescanIfOverflow(collectorData, threadData);
+}
+
+
+//moves the values recorded by the snapshot barrier in the buffers of the threads to the queue of overwritten values; 
+//the threads must be stopped
+static void flushOverwrittenPtrs(GCCollectorData& collectorData, const std::vector<GCThreadData*>& threadData) {
+    for (GCThreadData* data : threadData) {
+        collectorData.flushOverwrittenPtrs(*data);
     }
+}
 
-    //set the block cycle in order to mark the block as reachable
-    block->cycle = collectorData.cycle;
 
-    //move the block to the list of marked blocks
-    //so as that unmarked blocks are easily found later
-    block->detach();
-    block->owner->markedBlocks.append(block);
+//completes marking along with the mutators; the threads must be stopped. The mutators no longer modify pointers, 
+//and therefore the remaining recorded values and the deferred blocks are scanned
+static void finishSnapshotMarking(GCCollectorData& collectorData, const std::vector<GCThreadData*>& threadData) {
+    GCMarker& marker = *collectorData.markers[0];
+    collectorData.snapshotMarking.store(false, std::memory_order_relaxed);
+    flushOverwrittenPtrs(collectorData, threadData);
+    GCMarker::current = &marker;
+    marker.drainOverwrittenPtrs();
+    GCMarker::current = nullptr;
+    for (const std::unique_ptr<GCMarker>& deferringMarker : collectorData.markers) {
+        GCMarker::current = deferringMarker.get();
+        deferringMarker->scanDeferredBlocks();
+    }
+    GCMarker::current = nullptr;
+
+    //if an overwritten value could not be recorded, the blocks reachable from it are found 
+    //by scanning the roots and the marked blocks again
+    if (collectorData.overwrittenPtrsOverflow) {
+        collectorData.overwrittenPtrsOverflow = false;
+        GCMarker::current = &marker;
+        for (GCThreadData* data : threadData) {
+            marker.scan(data->ptrs);
+            marker.scan(data->shadowStack);
+            marker.drain();
+        }
+        rescanMarkedBlocks(collectorData, threadData, marker);
+        GCMarker::current = nullptr;
+    }
+
+    //if some blocks could not be pushed to a mark stack, 
+    //rescan the marked blocks until all reachable blocks are scanned
+    rescanIfOverflow(collectorData, threadData);
+}
+
+
+//marks reachable objects along with the mutators; the threads must be stopped, and they are stopped on return
+static void markConcurrently(GCCollectorData& collectorData, const std::vector<GCThreadData*>& threadData) {
+
+    //next cycle; used for marking reachable blocks
+    clearMarks(collectorData, threadData);
+
+    //snapshot the roots: the blocks they point to are marked and scheduled for scanning;
+    //the blocks reachable from the roots are either scanned or recorded by the barrier when they become unreachable
+    GCMarker& marker = *collectorData.markers[0];
+    GCMarker::current = &marker;
+    for (GCThreadData* data : threadData) {
+        marker.scan(data->ptrs);
+        marker.scan(data->shadowStack);
+    }
+    GCMarker::current = nullptr;
+
+    //let the mutators run; from now on, pointer stores record the overwritten values, and new blocks are allocated marked
+    collectorData.snapshotMarking.store(true, std::memory_order_relaxed);
+    releaseThreads(collectorData);
+
+    //mark the blocks reachable from the roots; the other markers steal blocks from the first one
+    std::atomic<size_t> activeMarkers{ collectorData.markers.size() };
+    collectorData.workers.run([&](size_t index) {
+        GCMarker& marker = *collectorData.markers[index];
+        GCMarker::current = &marker;
+        marker.drain();
+        while (marker.steal(collectorData.markers, activeMarkers)) {
+            marker.drain();
+        }
+        GCMarker::current = nullptr;
+    });
 
-    //increment the global allocation size by the size of the marked block
-    const size_t size = reinterpret_cast<char*>(block->end) - reinterpret_cast<char*>(block);
-    collectorData.allocSize.fetch_add(size, std::memory_order_relaxed);
+    //scan the values recorded by the barrier in the meantime, a few times, so as that few are left for the final pause
+    GCMarker::current = &marker;
+    for (size_t pass = 0; pass < ConcurrentBarrierPassCount && marker.drainOverwrittenPtrs(); ++pass) {
+    }
 
-    //scan the member pointers of the block
-    scan(collectorData, block->ptrs);
-    block->vtable.scan(block + 1, block->end);
+    //final pause
+    suspendThreads(collectorData);
+    GCMarker::current = nullptr;
+    finishSnapshotMarking(collectorData, threadData);
 }
 
 
-//scans a pointer
-static void scan(GCCollectorData& collectorData, void* value) {
+//marks reachable objects in slices; the threads must be stopped. The first slice scans the roots, and each slice 
+//marks until the deadline; between slices, the mutators run, and the snapshot barrier records the overwritten values.
+//Returns true if marking is complete, false if it must be continued by the next slice.
+static bool markIncrementally(GCCollectorData& collectorData, const std::vector<GCThreadData*>& threadData, std::chrono::steady_clock::time_point deadline) {
+    GCMarker& marker = *collectorData.markers[0];
 
-    //if null, don't do anything
-    if (!value) {
-        return;
+    //first slice; start a new cycle and snapshot the roots
+    if (!collectorData.incrementalMarking.load(std::memory_order_relaxed)) {
+        clearMarks(collectorData, threadData);
+        GCMarker::current = &marker;
+        for (GCThreadData* data : threadData) {
+            marker.scan(data->ptrs);
+            marker.scan(data->shadowStack);
+        }
+        collectorData.snapshotMarking.store(true, std::memory_order_relaxed);
+        collectorData.incrementalMarking.store(true, std::memory_order_release);
     }
 
-    //locate the block the pointer points to
-    GCBlockHeader* block = find(collectorData.blocks, value);
+    //scan the values recorded since the previous slice and the blocks reachable from them, until the deadline
+    flushOverwrittenPtrs(collectorData, threadData);
+    GCMarker::current = &marker;
+    const bool complete = marker.drainOverwrittenPtrs(deadline);
+    GCMarker::current = nullptr;
+    if (!complete) {
+        return false;
+    }
 
-    //if no block is found, do nothing else
-    if (!block) {
-        return;
+    //last slice
+    collectorData.incrementalMarking.store(false, std::memory_order_release);
+    finishSnapshotMarking(collectorData, threadData);
+    return true;
+}
+
+
+//returns the size of the blocks marked in the current cycle, including the blocks allocated marked
+static size_t getMarkedSize(GCCollectorData& collectorData) {
+    size_t result = collectorData.markedAllocSize.exchange(0, std::memory_order_relaxed);
+    for (const std::unique_ptr<GCMarker>& marker : collectorData.markers) {
+        result += marker->markedSize;
+        marker->markedSize = 0;
     }
+    return result;
+}
 
-    //mark the block as reachable
-    mark(collectorData, block);
+
+//checks if a block has member pointers outside of its memory, e.g. pointers of containers that are members of the object
+static bool hasExternalPtrs(const GCBlockHeader* block) noexcept {
+    const uintptr_t start = reinterpret_cast<uintptr_t>(block + 1);
+    const uintptr_t end = reinterpret_cast<uintptr_t>(block->end());
+    for (const GCPtrStruct* ptr = block->ptrs.first(); ptr != block->ptrs.end(); ptr = ptr->next) {
+        if (reinterpret_cast<uintptr_t>(ptr) < start || reinterpret_cast<uintptr_t>(ptr) >= end) {
+            return true;
+        }
+    }
+    return false;
 }
 
 
-//scans a pointer list
-static void scan(GCCollectorData& collectorData, const GCList<GCPtrStruct>& ptrs) {
-    for (const GCPtrStruct* ptr = ptrs.first(); ptr != ptrs.end(); ptr = ptr->next) {
-        scan(collectorData, ptr->value);
+//moves a young block to the old generation
+static void promoteBlock(GCCollectorData& collectorData, GCThreadData* data, GCBlockHeader* block) {
+    block->detach();
+    block->age = GCBlockHeader::OldAge;
+
+    //blocks without gc pointers are never scanned in young collections
+    if (block->descriptor().traits & GCIBlockHeaderVTable::NoPtrs) {
+        data->oldBlocks.append(block);
+    }
+
+    //the cards of the block are marked dirty, since the block might point to young blocks;
+    //the cards cover only the memory of the block, and therefore pointers stored outside of it,
+    //either registered to the block or visited by its scan function, are not remembered by them
+    else if (collectorData.pageMap.isArenaBlock(block) && (block->descriptor().traits & GCIBlockHeaderVTable::NoScan) && !hasExternalPtrs(block)) {
+        data->oldBlocks.append(block);
+        GCArena::markCards(block, block->size());
+    }
+
+    //blocks without cards, or with pointers outside of them
+    else {
+        data->oldScannedBlocks.append(block);
     }
 }
 
 
-//mark reachable objects
-static void mark(GCCollectorData& collectorData) {
+//moves the unmarked old blocks of a block list to the given list;
+//if not in generational mode, the marked old blocks are moved back to the young blocks of their thread;
+//returns the size of the blocks removed from the old generation
+static size_t gatherUnmarkedOldBlocks(GCCollectorData& collectorData, GCList<GCBlockHeader>& oldBlocks, GCList<GCBlockHeader>& blocks, GCList<GCBlockHeader>* youngBlocks) {
+    size_t result = 0;
+    for (GCBlockHeader* block = oldBlocks.first(); block != oldBlocks.end();) {
+        GCBlockHeader* next = block->next;
 
-    //gather all blocks so as that pointers to middle of blocks are allowed
-    gatherAllBlocks(collectorData);
+        //unreachable blocks are no longer old, so as that young collections do not scan them while they are swept
+        if (!collectorData.pageMap.isMarked(block, collectorData.cycle)) {
+            result += block->size();
+            block->age = 0;
+            block->detach();
+            blocks.append(block);
+        }
 
-    //if there are no blocks, then do nothing else
-    if (collectorData.blocks.empty()) {
-        return;
+        else if (youngBlocks) {
+            result += block->size();
+            block->age = 0;
+            block->detach();
+            youngBlocks->append(block);
+        }
+
+        block = next;
     }
+    return result;
+}
 
-    //next cycle; used for marking reachable blocks
-    ++collectorData.cycle;
 
-    //recompute the allocation size as objects are being marked
-    collectorData.allocSize.store(0, std::memory_order_relaxed);
+//moves the unmarked blocks of a thread data to the given list;
+//in generational mode, it promotes the surviving young blocks that are old enough
+static void gatherUnmarkedBlocks(GCCollectorData& collectorData, GCThreadData* data, GCList<GCBlockHeader>& blocks, bool generational) {
+    const size_t promotionAge = collectorData.promotionAge.load(std::memory_order_acquire);
+    size_t promotedSize = 0;
+    for (GCBlockHeader* block = data->blocks.first(); block != data->blocks.end();) {
+        GCBlockHeader* next = block->next;
+        if (!collectorData.pageMap.isMarked(block, collectorData.cycle)) {
+            block->detach();
+            blocks.append(block);
+        }
+        else if (generational && ++block->age >= promotionAge) {
+            promotedSize += block->size();
+            promoteBlock(collectorData, data, block);
+        }
+        block = next;
+    }
 
-    //scan pointers of active/terminated threads; also mark shareable blocks that are still shared
-    for (GCThreadData* data = collectorData.threads.first(); data != collectorData.threads.end(); data = data->next) {
-        scan(collectorData, data->ptrs);
+    //old blocks are collected only in full collections
+    size_t removedOldSize = 0;
+    if (!collectorData.youngCollection) {
+        GCList<GCBlockHeader>* youngBlocks = generational ? nullptr : &data->blocks;
+        removedOldSize += gatherUnmarkedOldBlocks(collectorData, data->oldBlocks, blocks, youngBlocks);
+        removedOldSize += gatherUnmarkedOldBlocks(collectorData, data->oldScannedBlocks, blocks, youngBlocks);
     }
-    for (GCThreadData* data = collectorData.terminatedThreads.first(); data != collectorData.terminatedThreads.end(); data = data->next) {
-        scan(collectorData, data->ptrs);
+
+    collectorData.oldSize.fetch_add(promotedSize, std::memory_order_relaxed);
+    collectorData.oldSize.fetch_sub(removedOldSize, std::memory_order_relaxed);
+}
+
+
+//clears the weak pointers to unreachable blocks; the threads must be stopped
+static void clearWeakPtrs(GCCollectorData& collectorData) {
+    std::lock_guard lock(collectorData.weakPtrsMutex);
+    for (GCWeakPtrStruct* ptr = collectorData.weakPtrs.first(); ptr != collectorData.weakPtrs.end(); ptr = ptr->next) {
+        void* value = ptr->value.load(std::memory_order_acquire);
+        if (!value) {
+            continue;
+        }
+
+        //in young collections, old blocks are not marked, but they are reachable
+        GCBlockHeader* block = collectorData.pageMap.find(value);
+        if (!block || (collectorData.youngCollection && block->age == GCBlockHeader::OldAge) || collectorData.pageMap.isMarked(block, collectorData.cycle)) {
+            continue;
+        }
+
+        //the value is cleared before the block is finalized, unless a mutator has stored another value meanwhile
+        ptr->value.compare_exchange_strong(value, nullptr, std::memory_order_acq_rel);
     }
 }
 
 
-//gathers unreachable blocks/threads; reset all blocks vector
-static void cleanup(GCCollectorData& collectorData, GCList<GCBlockHeader>& blocks, GCList<GCThreadData>& threads) {
+//gathers unreachable blocks/threads
+static void cleanup(GCCollectorData& collectorData, const std::vector<GCThreadData*>& threadData, GCList<GCBlockHeader>& blocks, GCList<GCThreadData>& threads, bool generational) {
 
-    //gather unreachable blocks from active threads; 
-    //move remaining unmarked objects to the unreachable blocks;
-    //move the marked blocks to the blocks
-    for (GCThreadData* data = collectorData.threads.first(); data != collectorData.threads.end(); data = data->next) {
-        blocks.append(std::move(data->blocks));
-        data->blocks = std::move(data->markedBlocks);
+    //clear the weak pointers to unreachable blocks, before the blocks are aged or promoted
+    clearWeakPtrs(collectorData);
+
+    //in young collections, old blocks are not marked, and therefore they are counted as live from the old generation size
+    const size_t unmarkedLiveSize = collectorData.youngCollection ? collectorData.oldSize.load(std::memory_order_relaxed) : 0;
+
+    //gather unreachable blocks from active/terminated threads, in parallel;
+    //each worker thread gathers blocks into its own list
+    std::vector<GCList<GCBlockHeader>> workerBlocks(collectorData.workers.getCount());
+    std::atomic<size_t> nextThreadData{ 0 };
+    collectorData.workers.run([&](size_t index) {
+        for (size_t dataIndex; (dataIndex = nextThreadData.fetch_add(1, std::memory_order_relaxed)) < threadData.size();) {
+            gatherUnmarkedBlocks(collectorData, threadData[dataIndex], workerBlocks[index], generational);
+        }
+    });
+    for (GCList<GCBlockHeader>& list : workerBlocks) {
+        blocks.append(std::move(list));
     }
 
-    //gather unreachable blocks from terminated threads;
-    //also gather empty thread data to delete later
+    //the thread lists and the allocation counters are modified below
+    std::lock_guard threadsLock(collectorData.threadsMutex);
+
+    //gather empty thread data of terminated threads to delete later
     for (GCThreadData* data = collectorData.terminatedThreads.first(); data != collectorData.terminatedThreads.end();) {
+        GCThreadData* next = data->next;
 
-        //if data are empty, put the data into the terminated threads list;
-        //unlock its mutex now, since it is to be removed from the list of terminated threads;
-        //if that is not done, the mutex will be destroyed while locked
+        //if data are empty, put the data into the terminated threads list
         if (data->empty()) {
-            GCThreadData* next = data->next;
-            data->mutex.unlock();
             data->detach();
             threads.append(data);
-            data = next;
         }
 
-        //else gather the blocks
-        else {
-            blocks.append(std::move(data->blocks));
-            data->blocks = std::move(data->markedBlocks);
-            data = data->next;
-        }
+        data = next;
     }
 
-    //the collectorData blocks are no longer needed; clear them for next collection
-    collectorData.blocks.clear();
-
-    //save the current allocation size
-    collectorData.lastCollectionAllocSize.store(collectorData.allocSize.load(std::memory_order_acquire), std::memory_order_release);
-}
-
-
-//sweeps a block
-static void sweep(GCBlockHeader* block) {
-    //set the collected flag
-    block->collected.store(true, std::memory_order::memory_order_release);
-
-    //if the block is shared via shared pointers, do not delete it
-    if (block->vtable.shared(block + 1, block->end)) {
-        return;
+    //the allocation size is now the size of the marked blocks; reset the allocation counters of threads
+    collectorData.liveSize = getMarkedSize(collectorData) + unmarkedLiveSize;
+    for (GCThreadData* data : threadData) {
+        data->allocSize.store(0, std::memory_order_relaxed);
+        data->freeSize.store(0, std::memory_order_relaxed);
+        data->unsharedAllocSize = 0;
     }
+    collectorData.allocSize.store(collectorData.liveSize, std::memory_order_release);
 
-    //delete the block
-    GCDeleteOperations::deleteBlock(block);
+    //save the current allocation size
+    collectorData.lastCollectionAllocSize.store(collectorData.liveSize, std::memory_order_release);
 }
 
 
 //sweeps unreachable blocks/threads
-static void sweep(const GCList<GCBlockHeader>& blocks, const GCList<GCThreadData>& threads) {
+static void sweep(GCCollectorData& collectorData, GCList<GCBlockHeader>& blocks, const GCList<GCThreadData>& threads) {
 
-    //sweep blocks
-    for (GCBlockHeader* block = blocks.first(); block != blocks.end();) {
-        GCBlockHeader* next = block->next;
-        sweep(block);
-        block = next;
+    //if sweeping is lazy or in the background, queue the blocks, so as that allocating threads
+    //or the background thread sweep them; otherwise, sweep the blocks, possibly in parallel, 
+    //along with any blocks queued while sweeping was lazy or in the background
+    if (collectorData.sweeper.isLazy() || collectorData.sweeper.isBackground()) {
+        collectorData.sweeper.add(std::move(blocks));
+    }
+    else {
+        collectorData.sweeper.sweep(blocks);
+        collectorData.sweeper.sweepQueued();
     }
 
-    //sweep threads
+    //sweep threads;
+    //the data of terminated threads are deleted only when their arenas are empty, i.e. when no queued blocks are in them
     for (GCThreadData* data = threads.first(); data != threads.end(); ) {
         GCThreadData* next = data->next;
         delete data;
@@ -262,48 +534,146 @@ static void sweep(const GCList<GCBlockHeader>& blocks, const GCList<GCThreadData
 }
 
 
-//collect garbage
-size_t GC::collect() {
-    GCCollectorData& collectorData = GCCollectorData::instance();
+//returns the memory of free arena pages to the system; the threads must be stopped
+static size_t releaseMemory(GCCollectorData& collectorData, const std::vector<GCThreadData*>& threadData, bool force) {
+    const auto now = std::chrono::steady_clock::now();
+    const std::chrono::steady_clock::duration decayTime = std::chrono::milliseconds(collectorData.memoryDecayTime.load(std::memory_order_acquire));
+
+    //the pages are examined at most once per decay time, since a page must be free for that time in order to be released
+    if (!force && now - collectorData.lastReleaseTime < decayTime) {
+        return 0;
+    }
+    collectorData.lastReleaseTime = now;
+
+    //the retention size is shared between all arenas
+    const size_t retentionSize = collectorData.memoryRetention.load(std::memory_order_acquire);
+    size_t retainedSize = 0;
+    size_t result = 0;
+    for (GCThreadData* data : threadData) {
+        result += data->arena->release(now, force ? std::chrono::steady_clock::duration::zero() : decayTime, retentionSize, retainedSize);
+        result += data->leafArena->release(now, force ? std::chrono::steady_clock::duration::zero() : decayTime, retentionSize, retainedSize);
+    }
+    return result;
+}
+
+
+//collects garbage; in generational mode, it collects the young generation only, unless a full collection is required
+static void collectGarbage(GCCollectorData& collectorData, bool full) {
 
     //stop threads that are using the collectorData;
     //if the global mutex was not acquired, it means
     //another thread is currently doing collection
     if (!stopThreads(collectorData)) {
-        return collectorData.allocSize.load(std::memory_order_acquire);
+        return;
     }
 
-    const size_t initialAllocSize = collectorData.allocSize.load(std::memory_order::memory_order_acquire);
+    //the deadline of incremental marking; if there is no pause budget, a collection in progress is completed
+    const std::chrono::microseconds pauseBudget(collectorData.pauseBudget.load(std::memory_order_acquire));
+    const std::chrono::steady_clock::time_point deadline = pauseBudget.count() > 0 && !full ? 
+        std::chrono::steady_clock::now() + pauseBudget : std::chrono::steady_clock::time_point::max();
 
-    //mark reachable blocks
-    mark(collectorData);
+    //if generational mode was toggled, pointers might have been modified without their cards being marked,
+    //and therefore the generations are reset by a non-generational collection
+    const bool generational = collectorData.generational.load(std::memory_order_acquire) && !collectorData.generationsReset;
+
+    //the thread data to collect; threads are not added or removed before this call returns
+    const std::vector<GCThreadData*> threadData = getThreadData(collectorData);
+
+    //mark reachable blocks; an incremental collection in progress is continued by this slice
+    bool marked = true;
+    if (collectorData.incrementalMarking.load(std::memory_order_relaxed)) {
+        marked = markIncrementally(collectorData, threadData, deadline);
+    }
+    else {
+        //the young generation is collected unless the old generation has grown enough since the last full collection
+        const size_t oldSize = collectorData.oldSize.load(std::memory_order_relaxed);
+        collectorData.youngCollection = generational && !full && 
+            oldSize < collectorData.lastFullCollectionOldSize + collectorData.fullCollectionThreshold.load(std::memory_order_acquire);
+
+        //young collections are short, and therefore only full collections mark incrementally or concurrently
+        if (collectorData.youngCollection) {
+            mark(collectorData, threadData);
+        }
+        else if (pauseBudget.count() > 0 && !full) {
+            marked = markIncrementally(collectorData, threadData, deadline);
+        }
+        else if (collectorData.concurrentMarking.load(std::memory_order_acquire)) {
+            markConcurrently(collectorData, threadData);
+        }
+        else {
+            mark(collectorData, threadData);
+        }
+    }
+
+    //if marking is not complete, let the mutators run until the next slice; 
+    //the collection thread runs it, unless another thread collects first
+    if (!marked) {
+        resumeThreads(collectorData);
+        GC::collectAsync();
+        return;
+    }
+    collectorData.generationsReset = false;
 
     //locate unreachable blocks/thread data
     GCList<GCBlockHeader> blocks;
     GCList<GCThreadData> threads;
-    cleanup(collectorData, blocks, threads);
+    cleanup(collectorData, threadData, blocks, threads, generational);
+
+    //the page map is no longer read for this collection
+    collectorData.pageMap.endCollection();
+
+    //the old generation size after a full collection is the base for deciding the next full collection
+    if (!collectorData.youngCollection) {
+        collectorData.lastFullCollectionOldSize = collectorData.oldSize.load(std::memory_order_relaxed);
+    }
+    collectorData.youngCollection = false;
+
+    //return the memory of the arena pages freed by previous sweeps, if they have been free for long enough
+    ::releaseMemory(collectorData, threadData, false);
+
+    //the blocks explicitly deleted while they were being marked are deleted after the threads resume
+    GCList<GCBlockHeader> deletedBlocks;
+    deletedBlocks.append(std::move(collectorData.deletedBlocks));
 
     //resume the previously stopped threads
     resumeThreads(collectorData);
 
+    //delete the blocks explicitly deleted while they were being marked
+    collectorData.sweeper.deleteBlocks(deletedBlocks);
+
     //delete blocks and threads while the program continues running
-    sweep(blocks, threads);
+    ::sweep(collectorData, blocks, threads);
+}
+
+
+//collect garbage
+size_t GC::collect() {
+    collectGarbage(GCCollectorData::instance(), false);
 
     //return allocated object size
-    return collectorData.allocSize.load(std::memory_order_acquire);
+    return getAllocSize();
+}
+
+
+//Collects both the young and the old generation.
+size_t GC::collectFull() {
+    collectGarbage(GCCollectorData::instance(), true);
+    return getAllocSize();
 }
 
 
 //Collects data asynchronously. 
 void GC::collectAsync() {
-    GCAsyncCollectionThread::instance().cond.notify_one();
+    GCAsyncCollectionThread::instance().request();
 }
 
 
 
-//Returns the current allocation size.
+//Returns the current allocation size, by aggregating the allocation counters of threads.
 size_t GC::getAllocSize() {
-    return GCCollectorData::instance().allocSize.load(std::memory_order_acquire);
+    GCCollectorData& collectorData = GCCollectorData::instance();
+    std::lock_guard lock(collectorData.threadsMutex);
+    return collectorData.getAllocSize();
 }
 
 
@@ -314,12 +684,265 @@ size_t GC::getAllocLimit() {
 
 
 //Sets the current allocation limit.
-void setAllocLimit(size_t limit) {
+void GC::setAllocLimit(size_t limit) {
     GCCollectorData::instance().allocLimit.store(limit, std::memory_order_release);
 }
 
 
+//Waits for the collector to finish, if it has requested the threads to stop.
+void GC::safepoint() {
+    GCThread::instance().safepoint();
+}
+
+
+//Checks if unreachable blocks are swept lazily.
+bool GC::getLazySweep() {
+    return GCCollectorData::instance().sweeper.isLazy();
+}
+
+
+//Enables/disables lazy sweeping.
+void GC::setLazySweep(bool lazy) {
+    GCCollectorData::instance().sweeper.setLazy(lazy);
+}
+
+
+//Checks if unreachable blocks are swept by a background thread.
+bool GC::getBackgroundSweep() {
+    return GCCollectorData::instance().sweeper.isBackground();
+}
+
+
+//Enables/disables background sweeping.
+void GC::setBackgroundSweep(bool background) {
+    GCCollectorData::instance().sweeper.setBackground(background);
+}
+
+
+//Returns the number of threads that sweep blocks in parallel.
+size_t GC::getSweeperThreadCount() {
+    return GCCollectorData::instance().sweeper.getThreadCount();
+}
+
+
+//Sets the number of threads that sweep blocks in parallel.
+void GC::setSweeperThreadCount(size_t count) {
+    GCCollectorData::instance().sweeper.setThreadCount(count);
+}
+
+
+//Sweeps all the blocks queued for lazy/background sweeping.
+void GC::sweep() {
+    GCCollectorData& collectorData = GCCollectorData::instance();
+    collectorData.sweeper.sweepQueued();
+    collectorData.sweeper.wait();
+}
+
+
+//Returns the maximum size of free arena pages retained.
+size_t GC::getMemoryRetention() {
+    return GCCollectorData::instance().memoryRetention.load(std::memory_order_acquire);
+}
+
+
+//Sets the maximum size of free arena pages retained.
+void GC::setMemoryRetention(size_t size) {
+    GCCollectorData::instance().memoryRetention.store(size, std::memory_order_release);
+}
+
+
+//Returns the minimum time an arena page must be free before its memory is returned to the system.
+std::chrono::milliseconds GC::getMemoryDecayTime() {
+    return std::chrono::milliseconds(GCCollectorData::instance().memoryDecayTime.load(std::memory_order_acquire));
+}
+
+
+//Sets the minimum time an arena page must be free before its memory is returned to the system.
+void GC::setMemoryDecayTime(std::chrono::milliseconds time) {
+    GCCollectorData::instance().memoryDecayTime.store(time.count(), std::memory_order_release);
+}
+
+
+//Returns the memory of free arena pages to the system immediately.
+size_t GC::releaseMemory() {
+    GCCollectorData& collectorData = GCCollectorData::instance();
+
+    //if a collection is in progress, it releases memory itself
+    if (!stopThreads(collectorData)) {
+        return 0;
+    }
+
+    const size_t result = ::releaseMemory(collectorData, getThreadData(collectorData), true);
+
+    resumeThreads(collectorData);
+
+    return result;
+}
+
+
+//Checks if arena pages are allocated from huge page regions.
+bool GC::getHugePages() {
+    return GCPageSource::getHugePages();
+}
+
+
+//Enables/disables huge pages for the arenas.
+void GC::setHugePages(bool hugePages) {
+    GCPageSource::setHugePages(hugePages);
+}
+
+
+//Returns the number of bytes mapped for large objects.
+size_t GC::getLargeObjectSize() {
+    return GCLargeObjectSpace::getSize();
+}
+
+
+//Checks if generational collection is enabled.
+bool GC::getGenerational() {
+    return GCCollectorData::instance().generational.load(std::memory_order_acquire);
+}
+
+
+//Enables/disables generational collection.
+void GC::setGenerational(bool generational) {
+    GCCollectorData& collectorData = GCCollectorData::instance();
+
+    //the global mutex is held during collection, and therefore the mode does not change while collecting
+    std::lock_guard<std::mutex> lock(collectorData.mutex);
+    if (collectorData.generational.exchange(generational, std::memory_order_acq_rel) != generational) {
+        collectorData.generationsReset = true;
+    }
+}
+
+
+//Returns the number of young collections a block must survive in order to be promoted to the old generation.
+size_t GC::getPromotionAge() {
+    return GCCollectorData::instance().promotionAge.load(std::memory_order_acquire);
+}
+
+
+//Sets the number of young collections a block must survive in order to be promoted to the old generation.
+void GC::setPromotionAge(size_t age) {
+    GCCollectorData::instance().promotionAge.store(std::clamp(age, size_t(1), size_t(GCBlockHeader::OldAge - 1)), std::memory_order_release);
+}
+
+
+//Returns the growth of the old generation that causes a full collection.
+size_t GC::getFullCollectionThreshold() {
+    return GCCollectorData::instance().fullCollectionThreshold.load(std::memory_order_acquire);
+}
+
+
+//Sets the growth of the old generation that causes a full collection.
+void GC::setFullCollectionThreshold(size_t size) {
+    GCCollectorData::instance().fullCollectionThreshold.store(size, std::memory_order_release);
+}
+
+
+//Returns the size of the old generation.
+size_t GC::getOldGenerationSize() {
+    return GCCollectorData::instance().oldSize.load(std::memory_order_acquire);
+}
+
+
+//Returns the maximum duration of the pauses of incremental marking.
+std::chrono::microseconds GC::getPauseBudget() {
+    return std::chrono::microseconds(GCCollectorData::instance().pauseBudget.load(std::memory_order_acquire));
+}
+
+
+//Sets the maximum duration of the pauses of incremental marking.
+void GC::setPauseBudget(std::chrono::microseconds budget) {
+    GCCollectorData::instance().pauseBudget.store(budget.count(), std::memory_order_release);
+}
+
+
+//Returns the duration of the longest pause of the last collection.
+std::chrono::microseconds GC::getLastPauseDuration() {
+    return std::chrono::microseconds(GCCollectorData::instance().lastPauseDuration.load(std::memory_order_acquire));
+}
+
+
+//Checks if an incremental collection is in progress.
+bool GC::isCollecting() {
+    return GCCollectorData::instance().incrementalMarking.load(std::memory_order_acquire);
+}
+
+
+//Checks if full collections mark blocks along with the mutators.
+bool GC::getConcurrentMarking() {
+    return GCCollectorData::instance().concurrentMarking.load(std::memory_order_acquire);
+}
+
+
+//Enables/disables concurrent marking.
+void GC::setConcurrentMarking(bool concurrent) {
+    GCCollectorData::instance().concurrentMarking.store(concurrent, std::memory_order_release);
+}
+
+
+//Returns the number of blocks whose memory is prefetched before a block is scanned.
+size_t GC::getPrefetchDistance() {
+    return GCCollectorData::instance().prefetchDistance.load(std::memory_order_acquire);
+}
+
+
+//Sets the number of blocks whose memory is prefetched before a block is scanned.
+void GC::setPrefetchDistance(size_t distance) {
+    GCCollectorData::instance().prefetchDistance.store(std::min(distance, GCPrefetchQueue::MaxDistance), std::memory_order_release);
+}
+
+
+//Returns the size of the header that precedes each garbage-collected object or array.
+size_t GC::getBlockHeaderSize() {
+    return sizeof(GCBlockHeader);
+}
+
+
+//Returns the number of threads that mark blocks in parallel.
+size_t GC::getMarkerThreadCount() {
+    GCCollectorData& collectorData = GCCollectorData::instance();
+    std::lock_guard<std::mutex> lock(collectorData.mutex);
+    return collectorData.workers.getCount();
+}
+
+
+//Sets the number of threads that mark blocks in parallel.
+void GC::setMarkerThreadCount(size_t count) {
+    GCCollectorData& collectorData = GCCollectorData::instance();
+
+    //the collector mutex is held during collection, and therefore the workers are idle
+    std::lock_guard<std::mutex> lock(collectorData.mutex);
+    collectorData.workers.setCount(count);
+    while (collectorData.markers.size() < collectorData.workers.getCount()) {
+        collectorData.markers.push_back(std::make_unique<GCMarker>(collectorData));
+    }
+    collectorData.markers.resize(collectorData.workers.getCount());
+}
+
+
 //Helper function used for scanning a pointer.
 void GCPtrOperations::scan(void* value) {
-    ::scan(GCCollectorData::instance(), value);
+    GCMarker::current->scan(value);
+}
+
+
+//Helper function used for storing a pointer value.
+void GCPtrOperations::store(void*& dst, void* value) {
+    GCCollectorData& collectorData = GCCollectorData::instance();
+
+    //while marking along with the mutators, the overwritten value is recorded, 
+    //so as that the blocks reachable when marking started are marked
+    if (collectorData.snapshotMarking.load(std::memory_order_relaxed)) {
+        collectorData.recordOverwrittenPtr(*GCThread::instance().data, dst);
+    }
+
+    //the markers might read the pointer at the same time
+    GCPtrAccess::store(dst, value);
+
+    //in generational mode, the card of the pointer is marked
+    if (collectorData.generational.load(std::memory_order_relaxed)) {
+        collectorData.pageMap.markCard(&dst);
+    }
 }
@@ -0,0 +1,396 @@
+#include <new>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#include "GCArena.hpp"
+#include "GCCollectorData.hpp"
+#include "GCPageSource.hpp"
+
+
+//size class table
+struct GCArenaSizeClassTable {
+    //slot size per size class
+    std::array<uint32_t, GCArena::SizeClassCount> slotSizes{};
+
+    //size class per allocation size, in units of slot alignment
+    std::array<uint8_t, GCArena::MaxSlotSize / GCArena::SlotAlignment + 1> sizeClasses{};
+};
+
+
+//computes the slot size of a size class;
+//classes are spaced by slot alignment up to 128 bytes, then each power of two is split in 4 classes
+static constexpr size_t computeSlotSize(size_t sizeClass) {
+    if (sizeClass < 8) {
+        return (sizeClass + 1) * GCArena::SlotAlignment;
+    }
+    const size_t base = size_t(128) << ((sizeClass - 8) / 4);
+    return base + ((sizeClass - 8) % 4 + 1) * (base / 4);
+}
+
+
+//computes the size class table
+static constexpr GCArenaSizeClassTable computeSizeClassTable() {
+    GCArenaSizeClassTable table;
+    size_t sizeClass = 0;
+    for (size_t index = 0; index < table.sizeClasses.size(); ++index) {
+        while (computeSlotSize(sizeClass) < index * GCArena::SlotAlignment) {
+            ++sizeClass;
+        }
+        table.sizeClasses[index] = static_cast<uint8_t>(sizeClass);
+    }
+    for (size_t index = 0; index < table.slotSizes.size(); ++index) {
+        table.slotSizes[index] = static_cast<uint32_t>(computeSlotSize(index));
+    }
+    return table;
+}
+
+
+//the size class table
+static constexpr GCArenaSizeClassTable sizeClassTable = computeSizeClassTable();
+
+
+static_assert(computeSlotSize(GCArena::SizeClassCount - 1) == GCArena::MaxSlotSize, "invalid size class count");
+
+
+//returns the size class of the given size
+static size_t getSizeClass(size_t size) noexcept {
+    return sizeClassTable.sizeClasses[(size + GCArena::SlotAlignment - 1) / GCArena::SlotAlignment];
+}
+
+
+//the default constructor
+GCArena::GCArena() noexcept {
+}
+
+
+//releases the pages of this arena
+GCArena::~GCArena() {
+    GCPageMap& pageMap = GCCollectorData::instance().pageMap;
+    for (Page* page = m_pages; page;) {
+        Page* next = page->next;
+        pageMap.removeArenaPage(page);
+        GCPageSource::free(page, PageSize);
+        page = next;
+    }
+}
+
+
+//allocates a slot for the given size
+void* GCArena::allocate(size_t size) noexcept {
+    const size_t sizeClassIndex = getSizeClass(size);
+    SizeClass& sizeClass = m_sizeClasses[sizeClassIndex];
+
+    //if the local free list is empty, get the slots freed by other threads
+    if (!sizeClass.freeList && sizeClass.remoteFreeList.load(std::memory_order_relaxed)) {
+        sizeClass.freeList = sizeClass.remoteFreeList.exchange(nullptr, std::memory_order_acquire);
+    }
+
+    //take a slot from the free list
+    if (FreeSlot* slot = sizeClass.freeList) {
+        sizeClass.freeList = slot->next;
+        ++m_allocCount;
+        return slot;
+    }
+
+    //carve a slot from the current page
+    Page* page = sizeClass.currentPage;
+    if (page) {
+        char* slot = page->carvePtr.load(std::memory_order_relaxed);
+        if (slot < page->carveEnd) {
+            page->carvePtr.store(slot + page->slotSize, std::memory_order_relaxed);
+            ++m_allocCount;
+            return slot;
+        }
+    }
+
+    //carve a slot from a new page
+    return allocateFromNewPage(sizeClass, sizeClassIndex);
+}
+
+
+//returns a slot to its arena
+void GCArena::free(void* mem) noexcept {
+    Page* page = reinterpret_cast<Page*>(reinterpret_cast<uintptr_t>(mem) & ~(PageSize - 1));
+    GCArena* arena = page->arena;
+    SizeClass& sizeClass = arena->m_sizeClasses[page->sizeClass];
+
+    //push the slot to the remote free list
+    FreeSlot* slot = reinterpret_cast<FreeSlot*>(mem);
+    slot->next = sizeClass.remoteFreeList.load(std::memory_order_relaxed);
+    while (!sizeClass.remoteFreeList.compare_exchange_weak(slot->next, slot, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+
+    //count the free after the slot is pushed, so as that the arena is not considered empty before
+    arena->m_freeCount.fetch_add(1, std::memory_order_release);
+}
+
+
+//returns many slots of the same page to their arena
+void GCArena::free(void* const* slots, size_t count) noexcept {
+    if (!count) {
+        return;
+    }
+
+    Page* page = reinterpret_cast<Page*>(reinterpret_cast<uintptr_t>(slots[0]) & ~(PageSize - 1));
+    GCArena* arena = page->arena;
+    SizeClass& sizeClass = arena->m_sizeClasses[page->sizeClass];
+
+    //link the slots
+    FreeSlot* first = reinterpret_cast<FreeSlot*>(slots[0]);
+    FreeSlot* last = first;
+    for (size_t index = 1; index < count; ++index) {
+        FreeSlot* slot = reinterpret_cast<FreeSlot*>(slots[index]);
+        last->next = slot;
+        last = slot;
+    }
+
+    //push the chain to the remote free list with one operation
+    last->next = sizeClass.remoteFreeList.load(std::memory_order_relaxed);
+    while (!sizeClass.remoteFreeList.compare_exchange_weak(last->next, first, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+
+    //count the frees after the slots are pushed, so as that the arena is not considered empty before
+    arena->m_freeCount.fetch_add(count, std::memory_order_release);
+}
+
+
+//returns the slot that contains the given address
+void* GCArena::findSlot(void* page, void* addr) noexcept {
+    Page* arenaPage = reinterpret_cast<Page*>(page);
+    char* firstSlot = reinterpret_cast<char*>(arenaPage) + FirstSlotOffset;
+
+    //the address points to the page header or to memory not carved yet;
+    //the acquire order pairs with the store of a reused page, so as that the slot size read below is the current one
+    if (addr < firstSlot || addr >= arenaPage->carvePtr.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+
+    const size_t slotIndex = static_cast<size_t>(reinterpret_cast<char*>(addr) - firstSlot) / arenaPage->slotSize;
+    return firstSlot + slotIndex * arenaPage->slotSize;
+}
+
+
+//sets the mark bit of a slot
+bool GCArena::mark(void* page, void* slot) noexcept {
+    const auto [word, bit] = getMarkBit(page, slot);
+
+    //the check before the modification avoids writing to words of marked slots
+    if (word->load(std::memory_order_relaxed) & bit) {
+        return false;
+    }
+    return !(word->fetch_or(bit, std::memory_order_relaxed) & bit);
+}
+
+
+//checks the mark bit of a slot
+bool GCArena::isMarked(void* page, void* slot) noexcept {
+    const auto [word, bit] = getMarkBit(page, slot);
+    return word->load(std::memory_order_relaxed) & bit;
+}
+
+
+//sets the dirty flag of a card
+void GCArena::markCard(void* page, void* addr) noexcept {
+    Page* arenaPage = reinterpret_cast<Page*>(page);
+    std::atomic<uint8_t>& card = arenaPage->cards[static_cast<size_t>(reinterpret_cast<char*>(addr) - reinterpret_cast<char*>(arenaPage)) / CardSize];
+
+    //the checks before the modifications avoid writing to cache lines of dirty cards
+    if (!card.load(std::memory_order_relaxed)) {
+        card.store(1, std::memory_order_relaxed);
+    }
+    if (!arenaPage->dirty.load(std::memory_order_relaxed)) {
+        arenaPage->dirty.store(true, std::memory_order_relaxed);
+    }
+}
+
+
+//marks dirty the cards of a slot
+void GCArena::markCards(void* slot, size_t size) noexcept {
+    Page* page = getPage(slot);
+    const size_t offset = static_cast<size_t>(reinterpret_cast<char*>(slot) - reinterpret_cast<char*>(page));
+    for (size_t cardIndex = offset / CardSize; cardIndex <= (offset + size - 1) / CardSize; ++cardIndex) {
+        page->cards[cardIndex].store(1, std::memory_order_relaxed);
+    }
+    page->dirty.store(true, std::memory_order_relaxed);
+}
+
+
+//clears the mark bits of all pages
+void GCArena::clearMarks() noexcept {
+    for (Page* page = m_pages; page; page = page->next) {
+        //only the words of the carved slots can have bits set
+        const size_t slotCount = static_cast<size_t>(page->carvePtr.load(std::memory_order_relaxed) - (reinterpret_cast<char*>(page) + FirstSlotOffset)) / page->slotSize;
+        for (size_t index = 0; index < (slotCount + 63) / 64; ++index) {
+            page->marks[index].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+
+//returns the memory of free pages to the system
+size_t GCArena::release(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::duration decayTime, size_t retentionSize, size_t& retainedSize) noexcept {
+    //move the slots freed by other threads to the local free lists, and count the free slots per page
+    for (Page* page = m_pages; page; page = page->next) {
+        page->freeSlotCount = 0;
+    }
+    for (SizeClass& sizeClass : m_sizeClasses) {
+        if (FreeSlot* remoteSlots = sizeClass.remoteFreeList.exchange(nullptr, std::memory_order_acquire)) {
+            FreeSlot* last = remoteSlots;
+            for (; last->next; last = last->next) {
+            }
+            last->next = sizeClass.freeList;
+            sizeClass.freeList = remoteSlots;
+        }
+        for (FreeSlot* slot = sizeClass.freeList; slot; slot = slot->next) {
+            ++getPage(slot)->freeSlotCount;
+        }
+    }
+
+    //find the pages to release; the pages slots are carved from are kept
+    bool found = false;
+    for (Page* page = m_pages; page; page = page->next) {
+        if (page->released || page == m_sizeClasses[page->sizeClass].currentPage) {
+            continue;
+        }
+
+        //the page has allocated slots
+        const size_t carvedSlotCount = static_cast<size_t>(page->carvePtr.load(std::memory_order_relaxed) - (reinterpret_cast<char*>(page) + FirstSlotOffset)) / page->slotSize;
+        if (page->freeSlotCount < carvedSlotCount) {
+            page->freeTime = {};
+            continue;
+        }
+
+        //the page was just found free
+        if (page->freeTime == std::chrono::steady_clock::time_point{}) {
+            page->freeTime = now;
+        }
+
+        //retain the page if it has not been free for long enough or if the retention size allows it
+        if (now - page->freeTime < decayTime || retainedSize + PageSize <= retentionSize) {
+            retainedSize += PageSize;
+            continue;
+        }
+
+        //release the page
+        page->released = true;
+        found = true;
+    }
+
+    if (!found) {
+        return 0;
+    }
+
+    //remove the slots of released pages from the free lists
+    for (SizeClass& sizeClass : m_sizeClasses) {
+        FreeSlot** link = &sizeClass.freeList;
+        while (FreeSlot* slot = *link) {
+            if (getPage(slot)->released) {
+                *link = slot->next;
+            }
+            else {
+                link = &slot->next;
+            }
+        }
+    }
+
+    //return the memory of released pages to the system; the page header is kept
+    size_t result = 0;
+    for (Page* page = m_pages; page; page = page->next) {
+        if (!page->released || page->carvePtr.load(std::memory_order_relaxed) == reinterpret_cast<char*>(page) + FirstSlotOffset) {
+            continue;
+        }
+        char* start = reinterpret_cast<char*>(page) + (FirstSlotOffset + SystemPageSize - 1) / SystemPageSize * SystemPageSize;
+        char* end = reinterpret_cast<char*>(page) + PageSize;
+#ifdef _WIN32
+        VirtualAlloc(start, end - start, MEM_RESET, PAGE_READWRITE);
+#else
+        madvise(start, end - start, MADV_DONTNEED);
+#endif
+        result += PageSize;
+
+        //the page has no slots until it is reused
+        page->carveEnd = reinterpret_cast<char*>(page) + FirstSlotOffset;
+        page->carvePtr.store(page->carveEnd, std::memory_order_relaxed);
+        for (std::atomic<uint64_t>& word : page->marks) {
+            word.store(0, std::memory_order_relaxed);
+        }
+        for (std::atomic<uint8_t>& card : page->cards) {
+            card.store(0, std::memory_order_relaxed);
+        }
+        page->dirty.store(false, std::memory_order_relaxed);
+        page->freeTime = {};
+        page->nextReleased = m_releasedPages;
+        m_releasedPages = page;
+    }
+
+    return result;
+}
+
+
+//checks if all slots are free
+bool GCArena::empty() const noexcept {
+    return m_allocCount == m_freeCount.load(std::memory_order_acquire);
+}
+
+
+//returns the page of a slot
+GCArena::Page* GCArena::getPage(const void* slot) noexcept {
+    return reinterpret_cast<Page*>(reinterpret_cast<uintptr_t>(slot) & ~(PageSize - 1));
+}
+
+
+//returns the mark word and bit of a slot
+std::pair<std::atomic<uint64_t>*, uint64_t> GCArena::getMarkBit(void* page, void* slot) noexcept {
+    Page* arenaPage = reinterpret_cast<Page*>(page);
+    const size_t slotIndex = static_cast<size_t>(reinterpret_cast<char*>(slot) - (reinterpret_cast<char*>(arenaPage) + FirstSlotOffset)) / arenaPage->slotSize;
+    return { arenaPage->marks + slotIndex / 64, uint64_t(1) << (slotIndex % 64) };
+}
+
+
+//allocates a slot from a new page
+void* GCArena::allocateFromNewPage(SizeClass& sizeClass, size_t sizeClassIndex) noexcept {
+    const size_t slotSize = sizeClassTable.slotSizes[sizeClassIndex];
+    char* firstSlot;
+
+    //reuse a released page; it is already registered
+    if (Page* page = m_releasedPages) {
+        m_releasedPages = page->nextReleased;
+        firstSlot = reinterpret_cast<char*>(page) + FirstSlotOffset;
+        page->sizeClass = static_cast<uint32_t>(sizeClassIndex);
+        page->slotSize = static_cast<uint32_t>(slotSize);
+        page->carveEnd = firstSlot + (PageSize - FirstSlotOffset) / slotSize * slotSize;
+        page->released = false;
+        page->carvePtr.store(firstSlot + slotSize, std::memory_order_release);
+        sizeClass.currentPage = page;
+        ++m_allocCount;
+        return firstSlot;
+    }
+
+    void* mem = GCPageSource::allocate(PageSize);
+
+    //out of memory
+    if (!mem) {
+        return nullptr;
+    }
+
+    //init the page
+    firstSlot = reinterpret_cast<char*>(mem) + FirstSlotOffset;
+    Page* page = ::new(mem) Page{ 
+        this, 
+        m_pages, 
+        static_cast<uint32_t>(sizeClassIndex), 
+        static_cast<uint32_t>(slotSize), 
+        firstSlot + slotSize, 
+        firstSlot + (PageSize - FirstSlotOffset) / slotSize * slotSize 
+    };
+    m_pages = page;
+    sizeClass.currentPage = page;
+
+    //register the page, so as that the collector can locate blocks within it
+    GCCollectorData::instance().pageMap.insertArenaPage(page);
+
+    ++m_allocCount;
+    return firstSlot;
+}
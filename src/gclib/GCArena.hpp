@@ -0,0 +1,278 @@
+#ifndef GCLIB_GCARENA_HPP
+#define GCLIB_GCARENA_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <array>
+#include <utility>
+#include <chrono>
+#include <algorithm>
+
+
+/**
+ * Per-thread, size-class-segregated memory arena.
+ *
+ * Memory is requested from the page source in pages of fixed size, which are carved into slots of equal size;
+ * each size class keeps a free list of slots, which is accessed only by the thread that owns the arena,
+ * and a lock-free list of slots freed by other threads (i.e. the collector), which is moved to the local
+ * free list when the local free list is exhausted.
+ *
+ * Each page also keeps a mark bitmap with one bit per slot, so as that the collector
+ * can mark blocks without writing to their memory, and a card table with one byte per card,
+ * which the write barrier sets when a pointer within the card is modified in generational mode.
+ *
+ * Pages are released when the arena is destroyed, i.e. when the thread data that own the arena are deleted.
+ * Before that, the memory of pages that have no allocated slots can be returned to the system,
+ * while their address range is kept, in order to be reused for new pages.
+ */
+class GCArena {
+public:
+    ///size of arena page; pages are aligned to this size, so as that the page of a slot can be found from the slot address.
+    static constexpr size_t PageSize = 64 * 1024;
+
+    ///slot alignment.
+    static constexpr size_t SlotAlignment = 16;
+
+    ///maximum slot size; larger allocations are served by the system allocator.
+    static constexpr size_t MaxSlotSize = 8 * 1024;
+
+    ///number of size classes.
+    static constexpr size_t SizeClassCount = 32;
+
+    ///size of the card the card table of a page keeps a dirty flag for.
+    static constexpr size_t CardSize = 512;
+
+    ///the default constructor.
+    GCArena() noexcept;
+
+    ///releases the pages of this arena.
+    ~GCArena();
+
+    GCArena(const GCArena&) = delete;
+    GCArena& operator = (const GCArena&) = delete;
+
+    /**
+     * Allocates a slot for the given size.
+     * Must be invoked only from the thread that owns the arena.
+     * @param size number of bytes; must not be greater than MaxSlotSize.
+     * @return pointer to the slot or null if the system is out of memory.
+     */
+    void* allocate(size_t size) noexcept;
+
+    /**
+     * Returns a slot to the free list of its size class of the arena it was allocated from.
+     * It can be invoked from any thread.
+     * @param mem slot returned from allocate.
+     */
+    static void free(void* mem) noexcept;
+
+    /**
+     * Returns many slots of the same page to their arena at once.
+     * It can be invoked from any thread.
+     * @param slots slots returned from allocate; they must belong to the same page.
+     * @param count number of slots.
+     */
+    static void free(void* const* slots, size_t count) noexcept;
+
+    /**
+     * Checks if the given slots belong to the same page.
+     * @param slot1 first slot.
+     * @param slot2 second slot.
+     * @return true if the slots belong to the same page, false otherwise.
+     */
+    static bool isSamePage(const void* slot1, const void* slot2) noexcept {
+        return ((reinterpret_cast<uintptr_t>(slot1) ^ reinterpret_cast<uintptr_t>(slot2)) & ~(PageSize - 1)) == 0;
+    }
+
+    /**
+     * Returns the slot that contains the given address.
+     * @param page arena page, as registered to the page map.
+     * @param addr address within the page.
+     * @return pointer to the slot or null if the address does not point to a slot that has been carved.
+     */
+    static void* findSlot(void* page, void* addr) noexcept;
+
+    /**
+     * Sets the mark bit of a slot.
+     * It can be invoked from any thread.
+     * @param page arena page, as registered to the page map.
+     * @param slot slot, as returned from findSlot.
+     * @return true if the slot was not marked before, false otherwise.
+     */
+    static bool mark(void* page, void* slot) noexcept;
+
+    /**
+     * Checks the mark bit of a slot.
+     * @param page arena page, as registered to the page map.
+     * @param slot slot, as returned from findSlot.
+     * @return true if the slot is marked, false otherwise.
+     */
+    static bool isMarked(void* page, void* slot) noexcept;
+
+    /**
+     * Sets the dirty flag of the card that contains the given address.
+     * It can be invoked from any thread.
+     * @param page arena page, as registered to the page map.
+     * @param addr address within the page.
+     */
+    static void markCard(void* page, void* addr) noexcept;
+
+    /**
+     * Marks dirty the cards a slot overlaps.
+     * @param slot slot returned from allocate.
+     * @param size number of bytes of the slot to mark the cards of.
+     */
+    static void markCards(void* slot, size_t size) noexcept;
+
+    /**
+     * Invokes the given function for each carved slot that overlaps a dirty card of this arena.
+     * The dirty flags are cleared, then the cards of slots for which the function returns true are marked dirty again.
+     * It must not be invoked while pointers are modified.
+     * @param func function to invoke; it receives the slot and returns true if the card(s) of the slot should be kept dirty.
+     */
+    template <class F> void scanCards(F&& func) {
+        for (Page* page = m_pages; page; page = page->next) {
+            if (!page->dirty.load(std::memory_order_relaxed)) {
+                continue;
+            }
+            page->dirty.store(false, std::memory_order_relaxed);
+
+            char* firstSlot = reinterpret_cast<char*>(page) + FirstSlotOffset;
+            char* lastSlotVisited = nullptr;
+            for (size_t cardIndex = FirstSlotOffset / CardSize; cardIndex < CardCount; ++cardIndex) {
+                if (!page->cards[cardIndex].load(std::memory_order_relaxed)) {
+                    continue;
+                }
+                page->cards[cardIndex].store(0, std::memory_order_relaxed);
+
+                //visit the slots that overlap the card, except the one visited for the previous card
+                char* cardStart = reinterpret_cast<char*>(page) + cardIndex * CardSize;
+                char* cardEnd = std::min(cardStart + CardSize, page->carvePtr.load(std::memory_order_relaxed));
+                char* slot = firstSlot + static_cast<size_t>(std::max(cardStart, firstSlot) - firstSlot) / page->slotSize * page->slotSize;
+                for (; slot < cardEnd; slot += page->slotSize) {
+                    if (slot != lastSlotVisited && func(static_cast<void*>(slot))) {
+                        markCards(slot, page->slotSize);
+                    }
+                    lastSlotVisited = slot;
+                }
+            }
+        }
+    }
+
+    /**
+     * Clears the mark bits of all the pages of this arena.
+     * It must not be invoked while blocks are being marked.
+     */
+    void clearMarks() noexcept;
+
+    /**
+     * Returns the memory of pages without allocated slots to the system.
+     * Pages are released only if they have been found free for the given decay time, 
+     * and only if the total size of free pages retained so far exceeds the given retention size.
+     * It must be invoked only while the owner thread does not allocate slots.
+     * @param now current time; used for timestamping pages found free.
+     * @param decayTime minimum time a page must be free in order to be released.
+     * @param retentionSize maximum size of free pages to retain.
+     * @param retainedSize size of free pages retained so far; updated with the free pages this arena retains.
+     * @return number of bytes released.
+     */
+    size_t release(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::duration decayTime, size_t retentionSize, size_t& retainedSize) noexcept;
+
+    /**
+     * Checks if all the slots allocated from this arena have been freed.
+     * @return true if there are no allocated slots, false otherwise.
+     */
+    bool empty() const noexcept;
+
+private:
+    //free slot
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    //number of words of the mark bitmap of a page; enough for a page of slots of minimum size
+    static constexpr size_t MarkWordCount = (PageSize / SlotAlignment + 63) / 64;
+
+    //number of cards of a page
+    static constexpr size_t CardCount = PageSize / CardSize;
+
+    //page header; placed at the start of each page
+    struct Page {
+        GCArena* arena;
+        Page* next;
+        uint32_t sizeClass;
+        uint32_t slotSize;
+
+        //next slot to carve; read by the collector while the owner thread allocates;
+        //when a released page is reused, it is stored after the slot size, with release order
+        std::atomic<char*> carvePtr;
+
+        char* carveEnd;
+        std::atomic<uint64_t> marks[MarkWordCount]{};
+
+        //dirty flags of the cards of the page
+        std::atomic<uint8_t> cards[CardCount]{};
+
+        //set if any card of the page is dirty
+        std::atomic<bool> dirty{ false };
+
+        //number of free slots; computed when releasing memory
+        uint32_t freeSlotCount{ 0 };
+
+        //set if the memory of the page is released
+        bool released{ false };
+
+        //time the page was first found free; zero if not free
+        std::chrono::steady_clock::time_point freeTime{};
+
+        //next released page
+        Page* nextReleased{ nullptr };
+    };
+
+    //size of the pages of the system; memory is returned to the system in multiples of it
+    static constexpr size_t SystemPageSize = 4096;
+
+    //offset of the first slot in a page; the page header is rounded up to a cache line
+    static constexpr size_t FirstSlotOffset = (sizeof(Page) + 63) / 64 * 64;
+
+    //size class data; aligned to cache line, so as that remote frees to one class do not interfere with the others
+    struct alignas(64) SizeClass {
+        //slots freed by the owner thread or moved from the remote free list
+        FreeSlot* freeList{ nullptr };
+
+        //slots freed by other threads
+        std::atomic<FreeSlot*> remoteFreeList{ nullptr };
+
+        //page slots are carved from
+        Page* currentPage{ nullptr };
+    };
+
+    //size classes
+    std::array<SizeClass, SizeClassCount> m_sizeClasses;
+
+    //pages of this arena
+    Page* m_pages{ nullptr };
+
+    //pages whose memory is released; they are reused before new pages are allocated
+    Page* m_releasedPages{ nullptr };
+
+    //number of allocations; modified only by the owner thread
+    size_t m_allocCount{ 0 };
+
+    //number of frees; modified by any thread
+    std::atomic<size_t> m_freeCount{ 0 };
+
+    //returns the page of a slot
+    static Page* getPage(const void* slot) noexcept;
+
+    //returns the mark word and bit of a slot
+    static std::pair<std::atomic<uint64_t>*, uint64_t> getMarkBit(void* page, void* slot) noexcept;
+
+    //allocates a slot from a new page
+    void* allocateFromNewPage(SizeClass& sizeClass, size_t sizeClassIndex) noexcept;
+};
+
+
+#endif //GCLIB_GCARENA_HPP
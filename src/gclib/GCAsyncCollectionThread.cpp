@@ -1,4 +1,6 @@
 #include <mutex>
+#include <thread>
+#include <algorithm>
 #include "GCAsyncCollectionThread.hpp"
 #include "gclib/GC.hpp"
 
@@ -18,19 +20,46 @@ GCAsyncCollectionThread::GCAsyncCollectionThread() : m_thread([this]() { run();
 
 //stops the collection thread
 GCAsyncCollectionThread::~GCAsyncCollectionThread() {
-    m_stop.store(true, std::memory_order_release);
-    cond.notify_one();
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop.store(true, std::memory_order_release);
+    }
+    m_cond.notify_one();
     m_thread.join();
 }
 
 
+//requests a collection
+void GCAsyncCollectionThread::request() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_requested = true;
+    }
+    m_cond.notify_one();
+}
+
+
 //the thread loop
 void GCAsyncCollectionThread::run() {
-    std::mutex mutex;
     for (;;) {
-        std::unique_lock lock(mutex);
-        cond.wait(lock);
-        if (m_stop.load(std::memory_order_acquire)) return;
+        //wait for a request; the lock is not held while collecting, because collections make requests
+        {
+            std::unique_lock lock(m_mutex);
+            m_cond.wait(lock, [&]() { return m_requested || m_stop.load(std::memory_order_relaxed); });
+            if (m_stop.load(std::memory_order_relaxed)) return;
+            m_requested = false;
+        }
         GC::collect();
+
+        //run the remaining slices of an incremental collection, letting the mutators run between them;
+        //the requests made so far are served by the next slice
+        while (GC::isCollecting() && !m_stop.load(std::memory_order_acquire)) {
+            std::this_thread::sleep_for(std::max(GC::getPauseBudget(), std::chrono::microseconds(1)));
+            {
+                std::lock_guard lock(m_mutex);
+                m_requested = false;
+            }
+            GC::collect();
+        }
     }
 }
@@ -4,19 +4,29 @@
 
 #include <thread>
 #include <atomic>
+#include <mutex>
 #include <condition_variable>
 
 
 ///runs collection in a background thread
 class GCAsyncCollectionThread {
 public:
-    ///condition variable to wait on
-    std::condition_variable cond;
-
     ///returns the one and only instance of this class
     static GCAsyncCollectionThread& instance();
 
+    ///requests a collection; a request made while the thread collects is not lost, but served when the thread waits again
+    void request();
+
 private:
+    //mutex for the request and stop flags
+    std::mutex m_mutex;
+
+    //condition variable to wait on
+    std::condition_variable m_cond;
+
+    //set when a collection is requested; cleared before each collection
+    bool m_requested{ false };
+
     //stop flag
     std::atomic<bool> m_stop{ false };
 
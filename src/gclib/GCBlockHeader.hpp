@@ -2,42 +2,83 @@
 #define GCLIB_GCBLOCKHEADER_HPP
 
 
+#include <cstdint>
+#include <atomic>
 #include "gclib/GCPtrStruct.hpp"
 #include "gclib/GCList.hpp"
 #include "gclib/GCIBlockHeaderVTable.hpp"
+#include "GCVTableRegistry.hpp"
 
 
 /**
  * Data that preceed a heap-allocated object.
+ *
+ * The header is kept compact: the block size is stored as 32 bits instead of an end pointer,
+ * the type descriptor is referred to by type id, and the mark state is kept outside of the block.
  */
 class GCBlockHeader : public GCNode<GCBlockHeader> {
 public:
-    ///member ptrs of this block.
-    GCList<GCPtrStruct> ptrs;
+    ///maximum block size, including the header.
+    static constexpr size_t MaxSize = UINT32_MAX;
+
+    ///age of blocks that belong to the old generation.
+    static constexpr uint8_t OldAge = UINT8_MAX;
 
-    ///end of block.
-    void* end;
+    ///flag set when the block is collected while it can be shared via shared pointers.
+    static constexpr uint8_t Collected = 1;
 
-    ///last gc cycle.
-    size_t cycle{ 0 };
+    ///flag set when pointers outside of the block memory were registered as member pointers of the block
+    ///during construction, e.g. pointers of containers that are members of the object; they might be destroyed
+    ///while the block is reachable, and therefore the pointer list of the block is not scanned along with the mutators.
+    static constexpr uint8_t ExternalPtrs = 2;
 
-    ///vtable that manages this block header
-    GCIBlockHeaderVTable& vtable;
-        
-    ///thread data the block belongs to.
-    struct GCThreadData* owner;
+    ///member ptrs of this block.
+    GCList<GCPtrStruct> ptrs;
 
-    ///collected flag.
-    std::atomic<bool> collected{ false };
+    ///flags of the block; see Collected and ExternalPtrs.
+    std::atomic<uint8_t> flags{ 0 };
+
+    ///number of collections the block has survived in generational mode, or OldAge if the block is promoted;
+    ///written only by the collector.
+    uint8_t age{ 0 };
 
     ///constructor.
-    GCBlockHeader(size_t size, GCIBlockHeaderVTable& vtable, struct GCThreadData* owner)
-        : end(reinterpret_cast<char*>(this) + size)
-        , vtable(vtable)
-        , owner(owner)
+    GCBlockHeader(size_t size, uint16_t typeId)
+        : m_typeId(typeId)
+        , m_size(static_cast<uint32_t>(size))
     {
     }
+
+    ///returns the size of the block, including the header.
+    size_t size() const noexcept {
+        return m_size;
+    }
+
+    ///returns the end of block.
+    void* end() const noexcept {
+        return const_cast<char*>(reinterpret_cast<const char*>(this)) + m_size;
+    }
+
+    ///returns the type descriptor that manages this block header.
+    const GCTypeDescriptor& descriptor() const noexcept {
+        return GCVTableRegistry::get(m_typeId);
+    }
+
+    ///sets the size of the block to 0, so as that no address is considered to point into the block after it is freed.
+    void clearSize() noexcept {
+        m_size = 0;
+    }
+
+private:
+    //type id of the descriptor that manages this block header
+    uint16_t m_typeId;
+
+    //size of block, including the header
+    uint32_t m_size;
 };
 
 
+static_assert(sizeof(GCBlockHeader) == 4 * sizeof(void*) + 8, "block header is not compact");
+
+
 #endif //GCLIB_GCBLOCKHEADER_HPP
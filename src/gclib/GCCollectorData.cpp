@@ -1,6 +1,43 @@
 #include "GCCollectorData.hpp"
 
 
+//the default constructor
+GCCollectorData::GCCollectorData() {
+    markers.push_back(std::make_unique<GCMarker>(*this));
+}
+
+
+//returns the exact allocation size
+size_t GCCollectorData::getAllocSize() const noexcept {
+    size_t result = liveSize;
+    for (const GCThreadData* data = threads.first(); data != threads.end(); data = data->next) {
+        result += data->allocSize.load(std::memory_order_relaxed) - data->freeSize.load(std::memory_order_relaxed);
+    }
+    for (const GCThreadData* data = terminatedThreads.first(); data != terminatedThreads.end(); data = data->next) {
+        result += data->allocSize.load(std::memory_order_relaxed) - data->freeSize.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+
+//moves the values of the buffer of a thread to the queue of overwritten values
+void GCCollectorData::flushOverwrittenPtrs(GCThreadData& data) noexcept {
+    if (data.overwrittenPtrCount == 0) {
+        return;
+    }
+    {
+        std::lock_guard lock(markMutex);
+        try {
+            overwrittenPtrs.insert(overwrittenPtrs.end(), data.overwrittenPtrs, data.overwrittenPtrs + data.overwrittenPtrCount);
+        }
+        catch (...) {
+            overwrittenPtrsOverflow = true;
+        }
+    }
+    data.overwrittenPtrCount = 0;
+}
+
+
 //Returns the one and only collector instance.
 GCCollectorData& GCCollectorData::instance() {
     static GCCollectorData collectorData;
@@ -2,10 +2,19 @@
 #define GCLIB_GCCOLLECTORDATA_HPP
 
 
-#include <vector>
 #include <atomic>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include "gclib/GCWeakPtrStruct.hpp"
 #include "GCThread.hpp"
 #include "GCBlockHeader.hpp"
+#include "GCPageMap.hpp"
+#include "GCMarker.hpp"
+#include "GCWorkerThreads.hpp"
+#include "GCSweeper.hpp"
 
 
 /**
@@ -13,9 +22,15 @@
  */
 class GCCollectorData {
 public:
-    ///current allocation size
+    ///approximate allocation size, used for checking the allocation limit;
+    ///threads add their allocations to it only when they exhaust their allocation budget
     std::atomic<size_t> allocSize{ 0 };
 
+    ///size of the blocks that were reachable at the last collection, 
+    ///plus the allocation counters of the thread data deleted since then;
+    ///protected by the threads mutex
+    size_t liveSize{ 0 };
+
     ///allocation limit, initially set to 64 MB; 
     ///due to value-based approach, C++ does not need a lot of GC memory
     ///for the majority of cases
@@ -27,9 +42,101 @@ public:
     ///the delta between allocation sizes that must be exceeded in order for an automatic collection to happen
     std::atomic<size_t> autoCollectAllocSizeDelta{ 1024 * 1024 };
 
+    ///maximum size of free arena pages that are retained instead of being returned to the system; initially 0.
+    std::atomic<size_t> memoryRetention{ 0 };
+
+    ///minimum time, in milliseconds, an arena page must be free before its memory is returned to the system; initially 1 second.
+    std::atomic<int64_t> memoryDecayTime{ 1000 };
+
+    ///the last time memory was returned to the system; protected by the global mutex.
+    std::chrono::steady_clock::time_point lastReleaseTime;
+
+    ///if set, blocks are separated in young and old generations, and most collections collect the young generation only.
+    std::atomic<bool> generational{ false };
+
+    ///number of young collections a block must survive in order to be promoted to the old generation; initially 2.
+    std::atomic<size_t> promotionAge{ 2 };
+
+    ///growth of the old generation since the last full collection that causes the next collection to be full; initially 32 MB.
+    std::atomic<size_t> fullCollectionThreshold{ 32 * 1024 * 1024 };
+
+    ///size of the blocks of the old generation.
+    std::atomic<size_t> oldSize{ 0 };
+
+    ///size of the old generation after the last full collection; protected by the global mutex.
+    size_t lastFullCollectionOldSize{ 0 };
+
+    ///set when generational mode is toggled; the next collection resets the generations. Protected by the global mutex.
+    bool generationsReset{ false };
+
+    ///set while the collector collects the young generation only; old blocks are then considered reachable.
+    bool youngCollection{ false };
+
+    ///if set, full collections mark blocks along with the mutators, between two short pauses.
+    std::atomic<bool> concurrentMarking{ false };
+
+    ///set while blocks are marked along with the mutators; pointer stores record the overwritten values
+    ///(snapshot-at-the-beginning barrier), and new blocks are allocated marked. It changes only while the threads are stopped.
+    std::atomic<bool> snapshotMarking{ false };
+
+    ///mutex that protects the queue of overwritten values and the blocks deleted while blocks are marked along with the mutators.
+    std::mutex markMutex;
+
+    ///values overwritten while blocks are marked along with the mutators, moved here from the buffers of the threads;
+    ///protected by the mark mutex.
+    std::vector<void*> overwrittenPtrs;
+
+    ///set if an overwritten value could not be recorded; the final pause then rescans the roots and the marked blocks.
+    ///Protected by the mark mutex.
+    bool overwrittenPtrsOverflow{ false };
+
+    ///maximum duration, in microseconds, of the pauses of incremental marking; if 0, marking is not incremental. Initially 0.
+    std::atomic<int64_t> pauseBudget{ 0 };
+
+    ///time the current pause started at; protected by the global mutex.
+    std::chrono::steady_clock::time_point pauseStart;
+
+    ///longest pause of the collection in progress; protected by the global mutex.
+    std::chrono::steady_clock::duration longestPause{ 0 };
+
+    ///duration of the longest pause of the last collection, in microseconds.
+    std::atomic<int64_t> lastPauseDuration{ 0 };
+
+    ///set while an incremental collection is in progress, i.e. between its pauses; modified under the global mutex.
+    std::atomic<bool> incrementalMarking{ false };
+
+    ///size of the blocks allocated marked; they are counted as live.
+    std::atomic<size_t> markedAllocSize{ 0 };
+
+    ///number of blocks whose memory each marker prefetches before scanning a block; if 0, nothing is prefetched.
+    std::atomic<size_t> prefetchDistance{ 8 };
+
+    ///blocks explicitly deleted from within a region while they were being marked; 
+    ///they are deleted when marking finishes. Protected by the mark mutex.
+    GCList<GCBlockHeader> deletedBlocks;
+
+    ///mutex that protects the list of weak pointers.
+    std::mutex weakPtrsMutex;
+
+    ///weak pointers; they are not scanned, and they are cleared when the blocks they point to are found unreachable.
+    GCList<GCWeakPtrStruct> weakPtrs;
+
     ///global mutex.
     std::mutex mutex;
 
+    ///set while the collector requires the threads to stay out of regions.
+    std::atomic<bool> stopRequested{ false };
+
+    ///mutex for waiting on the condition below.
+    std::mutex stopMutex;
+
+    ///signaled when the collector resumes the threads.
+    std::condition_variable stopCond;
+
+    ///mutex that protects the thread lists and the allocation counters of thread data
+    ///from being aggregated while they are modified; it is held only briefly.
+    std::mutex threadsMutex;
+
     ///list of active threads.
     GCList<GCThreadData> threads;
 
@@ -39,8 +146,39 @@ public:
     ///current gc cycle.
     size_t cycle{ 0 };
 
-    ///all known blocks
-    std::vector<GCBlockHeader*> blocks;
+    ///index of all known blocks
+    GCPageMap pageMap;
+
+    ///threads that execute the collection work in parallel
+    GCWorkerThreads workers;
+
+    ///one marker per worker thread, including the collecting thread
+    std::vector<std::unique_ptr<GCMarker>> markers;
+
+    ///sweeps unreachable blocks
+    GCSweeper sweeper;
+
+    ///the default constructor.
+    GCCollectorData();
+
+    ///returns the exact allocation size; the threads mutex must be locked.
+    size_t getAllocSize() const noexcept;
+
+    ///records a value overwritten while blocks are marked along with the mutators in the buffer of the given thread;
+    ///it must be invoked within a region of the thread. When the buffer is full, it is moved to the queue of overwritten values.
+    void recordOverwrittenPtr(GCThreadData& data, void* value) noexcept {
+        if (!value) {
+            return;
+        }
+        data.overwrittenPtrs[data.overwrittenPtrCount++] = value;
+        if (data.overwrittenPtrCount == GCThreadData::OverwrittenPtrCapacity) {
+            flushOverwrittenPtrs(data);
+        }
+    }
+
+    ///moves the values of the buffer of the given thread to the queue of overwritten values; 
+    ///it must be invoked within a region of the thread, or while the threads are stopped.
+    void flushOverwrittenPtrs(GCThreadData& data) noexcept;
 
     ///Returns the one and only collector instance.
     static GCCollectorData& instance();
@@ -2,7 +2,6 @@
 #include "gclib/GCThreadLock.hpp"
 #include "GCBlockHeader.hpp"
 #include "GCThread.hpp"
-#include "GCThread.hpp"
 #include "GCCollectorData.hpp"
 
 
@@ -11,34 +10,81 @@ void GCDeleteOperations::unregisterBlock(GCBlockHeader* block) {
     //remove the block from its thread
     block->detach();
 
-    //remove the block's size from the collector
-    const size_t size = reinterpret_cast<char*>(block->end) - reinterpret_cast<char*>(block);
-    GCCollectorData::instance().allocSize.fetch_sub(size, std::memory_order_relaxed);
+    //count the block's size in the thread's free size;
+    //the counter is written only by this thread, and therefore it is not atomically incremented
+    GCThreadData* data = GCThread::instance().data;
+    data->freeSize.store(data->freeSize.load(std::memory_order_relaxed) + block->size(), std::memory_order_relaxed);
+
+    //the block no longer counts in the old generation
+    if (block->age == GCBlockHeader::OldAge) {
+        GCCollectorData::instance().oldSize.fetch_sub(block->size(), std::memory_order_relaxed);
+    }
+}
+
+
+//removes a block from the index of blocks and frees its memory
+void GCDeleteOperations::freeBlock(GCBlockHeader* block) {
+    GCCollectorData::instance().pageMap.remove(block);
+    block->descriptor().free(block);
 }
 
 
 //internal block delete
 void GCDeleteOperations::deleteBlock(GCBlockHeader* block) {
+    const GCTypeDescriptor& descriptor = block->descriptor();
+    const uint8_t traits = descriptor.traits;
+
     //reset the block's pointers so as that the finalizer does not access dangling pointers
-    for (GCPtrStruct* ptr = block->ptrs.first(); ptr != block->ptrs.end(); ptr = ptr->next) {
-        ptr->mutex = nullptr;
-        ptr->value = nullptr;
+    if (!(traits & GCIBlockHeaderVTable::NoPtrs)) {
+        for (GCPtrStruct* ptr = block->ptrs.first(); ptr != block->ptrs.end(); ptr = ptr->next) {
+            ptr->mutex = nullptr;
+            ptr->value = nullptr;
+        }
+    }
+    if (traits & GCIBlockHeaderVTable::Traced) {
+        const GCPtrLayout& layout = descriptor.layout;
+        for (char* obj = reinterpret_cast<char*>(block + 1); obj + layout.stride <= block->end(); obj += layout.stride) {
+            for (size_t index = 0; index < layout.count; ++index) {
+                *reinterpret_cast<void**>(obj + layout.offsets[index]) = nullptr;
+            }
+        }
     }
 
     //finalize the object or objects
-    block->vtable.finalize(block + 1, block->end);
+    if (!(traits & GCIBlockHeaderVTable::TriviallyDestructible)) {
+        descriptor.finalize(block + 1, block->end());
+    }
 
     //free the memory occupied by the block
-    block->vtable.free(block);
+    freeBlock(block);
 }
 
 
 //delete and unregister a block
 void GCDeleteOperations::deleteAndUnregisterBlock(class GCBlockHeader* block) {
+    GCCollectorData& collectorData = GCCollectorData::instance();
+    GCThreadData* data = GCThread::instance().data;
+    bool marking;
     {
         GCThreadLock lock;
         unregisterBlock(block);
+        marking = collectorData.snapshotMarking.load(std::memory_order_relaxed);
+
+        //while marking along with the mutators, the markers might be scanning the block, and therefore the block
+        //is deleted after marking finishes; a thread in an outer region cannot wait for it, so the collector deletes the block
+        if (marking && data->regionDepth.load(std::memory_order_relaxed) > 1) {
+            std::lock_guard markLock(collectorData.markMutex);
+            collectorData.deletedBlocks.append(block);
+            return;
+        }
+    }
+
+    //wait for marking to finish
+    if (marking) {
+        std::unique_lock lock(collectorData.stopMutex);
+        collectorData.stopCond.wait(lock, [&]() { return !collectorData.snapshotMarking.load(std::memory_order_acquire); });
     }
+
     deleteBlock(block);
 }
 
@@ -55,7 +101,7 @@ void GCDeleteOperations::operatorDelete(void* ptr) {
 void GCDeleteOperations::operatorDeleteIfCollected(void* ptr) {
     if (ptr) {
         GCBlockHeader* block = reinterpret_cast<GCBlockHeader*>(ptr) - 1;
-        if (block->collected.load(std::memory_order::memory_order_acquire)) {
+        if (block->flags.load(std::memory_order::memory_order_acquire) & GCBlockHeader::Collected) {
             deleteBlock(block);
         }
     }
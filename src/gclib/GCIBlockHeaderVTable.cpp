@@ -0,0 +1,30 @@
+#include "gclib/GCIBlockHeaderVTable.hpp"
+#include "GCVTableRegistry.hpp"
+
+
+//registers the vtable
+GCIBlockHeaderVTable::GCIBlockHeaderVTable(uint8_t traits, const GCPtrLayout& layout) 
+    : m_descriptor{ traits, layout, nullptr, nullptr, nullptr, nullptr, this }
+    , m_index(GCVTableRegistry::insert(m_descriptor))
+{
+}
+
+
+//registers the vtable copy
+GCIBlockHeaderVTable::GCIBlockHeaderVTable(const GCIBlockHeaderVTable& vtable) : m_descriptor(vtable.m_descriptor) {
+    m_descriptor.vtable = this;
+    m_index = GCVTableRegistry::insert(m_descriptor);
+}
+
+
+//registers the vtable with the given descriptor
+GCIBlockHeaderVTable::GCIBlockHeaderVTable(const GCTypeDescriptor& descriptor) : m_descriptor(descriptor) {
+    m_descriptor.vtable = this;
+    m_index = GCVTableRegistry::insert(m_descriptor);
+}
+
+
+//unregisters the vtable
+GCIBlockHeaderVTable::~GCIBlockHeaderVTable() {
+    GCVTableRegistry::remove(m_index);
+}
@@ -0,0 +1,47 @@
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#include "GCLargeObjectSpace.hpp"
+
+
+//number of bytes currently mapped
+std::atomic<size_t> GCLargeObjectSpace::m_size{ 0 };
+
+
+//maps memory for a large block
+void* GCLargeObjectSpace::allocate(size_t size) noexcept {
+#ifdef _WIN32
+    void* mem = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        mem = nullptr;
+    }
+#endif
+
+    if (mem) {
+        m_size.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    return mem;
+}
+
+
+//unmaps the memory of a large block
+void GCLargeObjectSpace::free(void* mem, size_t size) noexcept {
+#ifdef _WIN32
+    VirtualFree(mem, 0, MEM_RELEASE);
+#else
+    munmap(mem, size);
+#endif
+
+    m_size.fetch_sub(size, std::memory_order_relaxed);
+}
+
+
+//returns the number of bytes currently mapped
+size_t GCLargeObjectSpace::getSize() noexcept {
+    return m_size.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,47 @@
+#ifndef GCLIB_GCLARGEOBJECTSPACE_HPP
+#define GCLIB_GCLARGEOBJECTSPACE_HPP
+
+
+#include <cstddef>
+#include <atomic>
+
+
+/**
+ * Memory for large blocks, mapped directly from the system.
+ *
+ * Each large block gets its own mapping, which is page-aligned and zero-filled,
+ * and which is unmapped when the block is freed, so as that large buffers do not fragment
+ * the heap and their memory is returned to the system as soon as they are swept.
+ */
+class GCLargeObjectSpace {
+public:
+    ///minimum size of a large block; smaller blocks are allocated from arenas or from the system allocator.
+    static constexpr size_t Threshold = 256 * 1024;
+
+    /**
+     * Maps memory for a large block.
+     * @param size number of bytes.
+     * @return pointer to zero-filled memory or null if the system is out of memory.
+     */
+    static void* allocate(size_t size) noexcept;
+
+    /**
+     * Unmaps the memory of a large block.
+     * @param mem memory returned from allocate.
+     * @param size number of bytes, as passed to allocate.
+     */
+    static void free(void* mem, size_t size) noexcept;
+
+    /**
+     * Returns the number of bytes currently mapped for large blocks.
+     * @return the number of bytes currently mapped for large blocks.
+     */
+    static size_t getSize() noexcept;
+
+private:
+    //number of bytes currently mapped
+    static std::atomic<size_t> m_size;
+};
+
+
+#endif //GCLIB_GCLARGEOBJECTSPACE_HPP
@@ -0,0 +1,34 @@
+#include "gclib/GCLocalPtr.hpp"
+#include "gclib/GCThreadLock.hpp"
+#include "GCThread.hpp"
+
+
+//pushes a slot to the shadow stack of the current thread
+std::atomic<void*>* GCLocalPtrPrivate::push(void* value) {
+    return GCThread::instance().shadowStack.push(value);
+}
+
+
+//pops a slot from the shadow stack of the current thread
+void GCLocalPtrPrivate::pop(std::atomic<void*>* slot) {
+    GCShadowStack& shadowStack = GCThread::instance().shadowStack;
+
+    //the top slot is popped without locking
+    if (shadowStack.isTop(slot)) {
+        shadowStack.pop();
+    }
+
+    //else the slot is released; the value is removed from the stack, 
+    //and therefore the collector must not run, in case the value is moved to a slot it has not scanned
+    else {
+        GCThreadLock lock;
+        GCShadowStack::free(slot);
+    }
+}
+
+
+//sets the value of a slot
+void GCLocalPtrPrivate::store(std::atomic<void*>* slot, void* value) {
+    GCThreadLock lock;
+    slot->store(value, std::memory_order_relaxed);
+}
@@ -0,0 +1,40 @@
+#include <new>
+#include "gclib/GCMallocOperations.hpp"
+#include "GCThread.hpp"
+#include "GCLargeObjectSpace.hpp"
+
+
+//allocates memory from the arena/leaf arena of the current thread, from the large object space or from the system allocator
+void* GCMallocOperations::malloc(size_t size, bool leaf) {
+    if (size <= GCArena::MaxSlotSize) {
+        GCThreadData* data = GCThread::instance().data;
+        return (leaf ? data->leafArena : data->arena)->allocate(size);
+    }
+    if (size >= GCLargeObjectSpace::Threshold) {
+        return GCLargeObjectSpace::allocate(size);
+    }
+    return ::operator new(size, std::nothrow);
+}
+
+
+//frees memory allocated by the function 'malloc'
+void GCMallocOperations::free(void* mem) {
+    GCBlockHeader* block = reinterpret_cast<GCBlockHeader*>(mem);
+    if (block->size() <= GCArena::MaxSlotSize) {
+        //mark the slot as free, so as that it is not mistaken for a block
+        block->clearSize();
+        GCArena::free(mem);
+    }
+    else if (block->size() >= GCLargeObjectSpace::Threshold) {
+        GCLargeObjectSpace::free(mem, block->size());
+    }
+    else {
+        ::operator delete(mem);
+    }
+}
+
+
+//checks if memory allocated by the function 'malloc' is zero-filled
+bool GCMallocOperations::isZeroed(size_t size) {
+    return size >= GCLargeObjectSpace::Threshold;
+}
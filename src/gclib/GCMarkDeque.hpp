@@ -0,0 +1,108 @@
+#ifndef GCLIB_GCMARKDEQUE_HPP
+#define GCLIB_GCMARKDEQUE_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+
+
+class GCBlockHeader;
+
+
+/**
+ * Fixed-capacity work-stealing deque of blocks to scan (Chase-Lev).
+ *
+ * The owner thread pushes and pops blocks at the bottom end,
+ * while other threads steal blocks from the top end.
+ */
+class GCMarkDeque {
+public:
+    ///capacity of the deque.
+    static constexpr int64_t Capacity = 4096;
+
+    /**
+     * Pushes a block at the bottom end; only the owner thread can invoke it.
+     * @param block block to push.
+     * @return true if the block was pushed, false if the deque is full.
+     */
+    bool push(GCBlockHeader* block) noexcept {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        const int64_t top = m_top.load(std::memory_order_acquire);
+        if (bottom - top >= Capacity) {
+            return false;
+        }
+        m_entries[bottom & (Capacity - 1)].store(block, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * Pops a block from the bottom end; only the owner thread can invoke it.
+     * @return the popped block or null if the deque is empty.
+     */
+    GCBlockHeader* pop() noexcept {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+
+        //empty deque
+        if (top > bottom) {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        GCBlockHeader* block = m_entries[bottom & (Capacity - 1)].load(std::memory_order_relaxed);
+
+        //last block; race against thieves
+        if (top == bottom) {
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                block = nullptr;
+            }
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        return block;
+    }
+
+    /**
+     * Steals a block from the top end; any thread can invoke it.
+     * @return the stolen block or null if the deque is empty or another thread won the race for the block.
+     */
+    GCBlockHeader* steal() noexcept {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return nullptr;
+        }
+        GCBlockHeader* block = m_entries[top & (Capacity - 1)].load(std::memory_order_relaxed);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return block;
+    }
+
+    /**
+     * Checks if the deque is empty; the result might be stale if other threads use the deque.
+     * @return true if the deque is empty, false otherwise.
+     */
+    bool empty() const noexcept {
+        return m_bottom.load(std::memory_order_acquire) <= m_top.load(std::memory_order_acquire);
+    }
+
+private:
+    //top end; modified by thieves
+    alignas(64) std::atomic<int64_t> m_top{ 0 };
+
+    //bottom end; modified by the owner
+    alignas(64) std::atomic<int64_t> m_bottom{ 0 };
+
+    //entries
+    std::atomic<GCBlockHeader*> m_entries[Capacity];
+};
+
+
+#endif //GCLIB_GCMARKDEQUE_HPP
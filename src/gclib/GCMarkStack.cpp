@@ -0,0 +1,41 @@
+#include <new>
+#include <algorithm>
+#include "GCMarkStack.hpp"
+
+
+//the default constructor
+GCMarkStack::GCMarkStack() noexcept {
+}
+
+
+//frees the stack memory
+GCMarkStack::~GCMarkStack() {
+    delete[] m_begin;
+}
+
+
+//doubles the capacity
+bool GCMarkStack::grow() noexcept {
+    const size_t capacity = static_cast<size_t>(m_end - m_begin);
+    const size_t newCapacity = capacity ? capacity * 2 : InitialCapacity;
+
+    //the maximum capacity is reached
+    if (newCapacity > MaxCapacity) {
+        return false;
+    }
+
+    //allocate the new memory
+    GCBlockHeader** mem = new (std::nothrow) GCBlockHeader*[newCapacity];
+    if (!mem) {
+        return false;
+    }
+
+    //move the existing entries
+    const size_t size = static_cast<size_t>(m_top - m_begin);
+    std::copy(m_begin, m_top, mem);
+    delete[] m_begin;
+    m_begin = mem;
+    m_top = mem + size;
+    m_end = mem + newCapacity;
+    return true;
+}
@@ -0,0 +1,98 @@
+#ifndef GCLIB_GCMARKSTACK_HPP
+#define GCLIB_GCMARKSTACK_HPP
+
+
+#include <cstddef>
+
+
+class GCBlockHeader;
+
+
+/**
+ * Stack of marked blocks that have not been scanned yet.
+ *
+ * It grows on demand, up to a maximum capacity; if it cannot grow,
+ * the block is not pushed and the overflow flag is set, so as that
+ * the collector can rescan the marked blocks in order to find the blocks that were not pushed.
+ */
+class GCMarkStack {
+public:
+    ///initial capacity.
+    static constexpr size_t InitialCapacity = 4096;
+
+    ///maximum capacity.
+    static constexpr size_t MaxCapacity = size_t(1) << 24;
+
+    ///the default constructor.
+    GCMarkStack() noexcept;
+
+    ///frees the stack memory.
+    ~GCMarkStack();
+
+    GCMarkStack(const GCMarkStack&) = delete;
+    GCMarkStack& operator = (const GCMarkStack&) = delete;
+
+    /**
+     * Pushes a block.
+     * @param block block to push.
+     * @return true if the block was pushed, false if the stack overflowed.
+     */
+    bool push(GCBlockHeader* block) noexcept {
+        if (m_top == m_end && !grow()) {
+            m_overflow = true;
+            return false;
+        }
+        *m_top++ = block;
+        return true;
+    }
+
+    /**
+     * Pops a block.
+     * @return the last pushed block or null if the stack is empty.
+     */
+    GCBlockHeader* pop() noexcept {
+        return m_top > m_begin ? *--m_top : nullptr;
+    }
+
+    /**
+     * Returns the number of blocks in the stack.
+     * @return the number of blocks in the stack.
+     */
+    size_t size() const noexcept {
+        return static_cast<size_t>(m_top - m_begin);
+    }
+
+    /**
+     * Checks if a block could not be pushed since the last reset.
+     * @return true if the stack overflowed, false otherwise.
+     */
+    bool overflow() const noexcept {
+        return m_overflow;
+    }
+
+    /**
+     * Resets the overflow flag.
+     */
+    void resetOverflow() noexcept {
+        m_overflow = false;
+    }
+
+private:
+    //stack memory
+    GCBlockHeader** m_begin{ nullptr };
+
+    //top of stack
+    GCBlockHeader** m_top{ nullptr };
+
+    //end of stack memory
+    GCBlockHeader** m_end{ nullptr };
+
+    //overflow flag
+    bool m_overflow{ false };
+
+    //doubles the capacity; returns false if the maximum capacity is reached or memory allocation failed
+    bool grow() noexcept;
+};
+
+
+#endif //GCLIB_GCMARKSTACK_HPP
@@ -0,0 +1,412 @@
+#include <thread>
+#include <algorithm>
+#include "GCMarker.hpp"
+#include "GCCollectorData.hpp"
+#include "GCPtrAccess.hpp"
+#if (defined(_M_X64) || defined(_M_IX86)) && !defined(__GNUC__)
+#include <xmmintrin.h>
+#endif
+
+
+//maximum number of blocks to move from the stack to the deque at once
+static constexpr size_t MaxShareCount = 64;
+
+
+//number of blocks scanned between two checks of the deadline
+static constexpr size_t DeadlineCheckInterval = 64;
+
+
+//number of pointer values filtered at once by batch scans
+static constexpr size_t FilterBatchSize = 256;
+
+
+//prefetches the cache line that contains the given address
+static inline void prefetch(const void* address) noexcept {
+#if defined(__GNUC__)
+    __builtin_prefetch(address);
+#elif defined(_M_X64) || defined(_M_IX86)
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#endif
+}
+
+
+//size of the cache lines prefetched
+static constexpr uintptr_t CacheLineSize = 64;
+
+
+//maximum number of cache lines of the pointer slots of a block prefetched before the block is scanned
+static constexpr size_t MaxPrefetchLineCount = 8;
+
+
+//prefetches the cache lines that the given memory range covers, up to the maximum number of lines
+static inline void prefetchRange(const void* start, const void* end) noexcept {
+    const uintptr_t first = reinterpret_cast<uintptr_t>(start) & ~(CacheLineSize - 1);
+    const uintptr_t last = std::min(reinterpret_cast<uintptr_t>(end), first + MaxPrefetchLineCount * CacheLineSize);
+    for (uintptr_t line = first; line < last; line += CacheLineSize) {
+        prefetch(reinterpret_cast<const void*>(line));
+    }
+}
+
+
+//marker of the current thread
+thread_local GCMarker* GCMarker::current = nullptr;
+
+
+//constructor
+GCMarker::GCMarker(GCCollectorData& collectorData) noexcept : m_collectorData(collectorData) {
+}
+
+
+//marks a block as reachable
+void GCMarker::mark(GCBlockHeader* block) noexcept {
+    //in young collections, old blocks are considered reachable, and they are not scanned
+    if (block->age == GCBlockHeader::OldAge && m_collectorData.youngCollection) {
+        return;
+    }
+
+    //if the block is already marked, do nothing else;
+    //the mark is kept outside of the block, so as that the memory of reachable blocks is not written
+    if (!m_collectorData.pageMap.mark(block, m_collectorData.cycle)) {
+        return;
+    }
+
+    //count the size of the marked block
+    markedSize += block->size();
+
+    //blocks without gc pointers need not be scanned
+    if (block->descriptor().traits & GCIBlockHeaderVTable::NoPtrs) {
+        return;
+    }
+
+    //schedule the block for scanning; if the stack overflows, 
+    //the block will be scanned when the marked blocks are rescanned
+    m_stack.push(block);
+}
+
+
+//marks the block a pointer points to
+void GCMarker::scan(void* value) noexcept {
+
+    //if null, don't do anything
+    if (!value) {
+        return;
+    }
+
+    //locate the block the pointer points to
+    GCBlockHeader* block = m_collectorData.pageMap.find(value);
+
+    //if no block is found, do nothing else
+    if (!block) {
+        return;
+    }
+
+    //note the pointer to a young block, so as that the card of an old block that contains it is kept dirty
+    if (block->age != GCBlockHeader::OldAge) {
+        m_youngFound = true;
+    }
+
+    //mark the block as reachable
+    mark(block);
+}
+
+
+//marks the blocks an array of pointers point to
+void GCMarker::scan(const void* const* values, size_t count) noexcept {
+    //only the values within the address range of the heap are looked up
+    void* candidates[FilterBatchSize];
+    for (size_t index = 0; index < count; index += FilterBatchSize) {
+        const size_t candidateCount = m_collectorData.pageMap.filter(values + index, std::min(count - index, FilterBatchSize), candidates);
+        for (size_t candidateIndex = 0; candidateIndex < candidateCount; ++candidateIndex) {
+            scan(candidates[candidateIndex]);
+        }
+    }
+}
+
+
+//scans a pointer list
+void GCMarker::scan(const GCList<GCPtrStruct>& ptrs) noexcept {
+    for (const GCPtrStruct* ptr = ptrs.first(); ptr != ptrs.end(); ptr = ptr->next) {
+        scan(ptr->value);
+    }
+}
+
+
+//scans the slots of a shadow stack
+void GCMarker::scan(const GCShadowStack& shadowStack) noexcept {
+    shadowStack.forEach([&](void* value) {
+        scan(value);
+    });
+}
+
+
+//scans the member pointers of a block
+void GCMarker::scan(GCBlockHeader* block) noexcept {
+    const GCTypeDescriptor& descriptor = block->descriptor();
+    scan(block->ptrs);
+    if (descriptor.traits & GCIBlockHeaderVTable::Traced) {
+        scanLayout(descriptor.layout, block + 1, block->end());
+    }
+
+    //the scan function is invoked only for objects with manually traced pointers
+    if (!(descriptor.traits & GCIBlockHeaderVTable::NoScan)) {
+        descriptor.scan(block + 1, block->end(), m_tracer);
+    }
+}
+
+
+//scans the member pointers of an old block
+bool GCMarker::scanOld(GCBlockHeader* block) noexcept {
+    m_youngFound = false;
+    scan(block);
+    return m_youngFound;
+}
+
+
+//scans blocks until there are no more blocks to scan
+void GCMarker::drain() noexcept {
+    m_prefetchDistance = m_collectorData.prefetchDistance.load(std::memory_order_relaxed);
+    while (GCBlockHeader* block = next()) {
+        scanScheduled(block);
+        share();
+    }
+}
+
+
+//scans blocks until there are no more blocks to scan or the deadline passes
+bool GCMarker::drain(std::chrono::steady_clock::time_point deadline) noexcept {
+    m_prefetchDistance = m_collectorData.prefetchDistance.load(std::memory_order_relaxed);
+    for (size_t scanCount = 1;; ++scanCount) {
+        GCBlockHeader* block = next();
+        if (!block) {
+            return true;
+        }
+        scanScheduled(block);
+        share();
+
+        //the clock is read periodically, since reading it is not free;
+        //the blocks left in the prefetch queue are scanned by the next slice
+        if (scanCount % DeadlineCheckInterval == 0 && std::chrono::steady_clock::now() >= deadline) {
+            return m_stack.size() == 0 && m_deque.empty() && m_prefetchQueue.size() == 0;
+        }
+    }
+}
+
+
+//scans the values recorded by the snapshot barrier
+bool GCMarker::drainOverwrittenPtrs() noexcept {
+    const bool result = scanOverwrittenPtrs();
+    drain();
+    return result;
+}
+
+
+//scans the values recorded by the snapshot barrier, until the deadline passes
+bool GCMarker::drainOverwrittenPtrs(std::chrono::steady_clock::time_point deadline) noexcept {
+    scanOverwrittenPtrs();
+    return drain(deadline);
+}
+
+
+//scans the deferred blocks
+void GCMarker::scanDeferredBlocks() noexcept {
+    for (GCBlockHeader* block : m_deferredBlocks) {
+        scan(block);
+        drain();
+    }
+    m_deferredBlocks.clear();
+}
+
+
+//steals a block from another marker
+bool GCMarker::steal(const std::vector<std::unique_ptr<GCMarker>>& markers, std::atomic<size_t>& activeMarkers) noexcept {
+
+    //this marker has no more work
+    activeMarkers.fetch_sub(1, std::memory_order_acq_rel);
+
+    for (;;) {
+        //look for a marker with blocks in its deque;
+        //the marker is counted as active while stealing, so as that marking is not considered complete
+        //while the stolen block is not yet in its stack
+        for (const std::unique_ptr<GCMarker>& marker : markers) {
+            if (marker.get() == this || marker->m_deque.empty()) {
+                continue;
+            }
+            activeMarkers.fetch_add(1, std::memory_order_acq_rel);
+            if (GCBlockHeader* block = marker->m_deque.steal()) {
+                m_stack.push(block);
+                return true;
+            }
+            activeMarkers.fetch_sub(1, std::memory_order_acq_rel);
+        }
+
+        //markers put blocks in their deques only while they are active,
+        //and therefore, if there are no active markers, there is no more work
+        if (activeMarkers.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+
+        std::this_thread::yield();
+    }
+}
+
+
+//checks if the mark stack overflowed
+bool GCMarker::overflow() const noexcept {
+    return m_stack.overflow() || m_deferredBlocksOverflow;
+}
+
+
+//resets the overflow flag
+void GCMarker::resetOverflow() noexcept {
+    m_stack.resetOverflow();
+    m_deferredBlocksOverflow = false;
+}
+
+
+//moves the values recorded by the snapshot barrier to the stack
+bool GCMarker::scanOverwrittenPtrs() noexcept {
+    std::vector<void*> values;
+    {
+        std::lock_guard lock(m_collectorData.markMutex);
+        values.swap(m_collectorData.overwrittenPtrs);
+    }
+    for (void* value : values) {
+        scan(value);
+    }
+    return !values.empty();
+}
+
+
+//returns the next block to scan
+GCBlockHeader* GCMarker::next() noexcept {
+    for (;;) {
+        GCBlockHeader* block = m_stack.pop();
+        if (!block) {
+            block = m_deque.pop();
+
+            //if there are no more blocks to take, the blocks of the queue are scanned
+            if (!block) {
+                return m_prefetchQueue.pop();
+            }
+        }
+
+        //the header of the block is already cached, since it was read when the block was marked;
+        //the pointer slots of the block are fetched while the blocks ahead of it in the queue are scanned
+        if (m_prefetchDistance > 0) {
+            prefetchPtrs(block);
+        }
+        m_prefetchQueue.push(block);
+
+        //the queue is filled up to the prefetch distance before a block is scanned
+        if (m_prefetchQueue.size() > m_prefetchDistance) {
+            return m_prefetchQueue.pop();
+        }
+    }
+}
+
+
+//prefetches the cache lines of the pointer slots of a block
+void GCMarker::prefetchPtrs(GCBlockHeader* block) noexcept {
+    const GCTypeDescriptor& descriptor = block->descriptor();
+
+    const char* const start = reinterpret_cast<const char*>(block + 1);
+    const char* const end = static_cast<const char*>(block->end());
+
+    //the pointers declared via GC_TRACE are found at constant offsets; in an array, they span all the objects,
+    //otherwise they span the range from the lowest to the highest offset
+    if (descriptor.traits & GCIBlockHeaderVTable::Traced) {
+        const GCPtrLayout& layout = descriptor.layout;
+        const auto [minOffset, maxOffset] = std::minmax_element(layout.offsets, layout.offsets + layout.count);
+        prefetchRange(start + *minOffset, start + 2 * layout.stride <= end ? end : start + *maxOffset + sizeof(void*));
+    }
+
+    //the member pointers of the list follow each other in the memory of the block, starting from the first one;
+    //the link is read atomically, since the mutators might modify it while blocks are marked along with them
+    const GCPtrStruct* const first = GCPtrAccess::load(block->ptrs.next);
+    if (first != block->ptrs.end()) {
+        const char* const firstPtr = reinterpret_cast<const char*>(first);
+        if (firstPtr >= start && firstPtr < end) {
+            prefetchRange(firstPtr, end);
+        }
+        else {
+            prefetch(first);
+        }
+    }
+}
+
+
+//scans a block taken from the stack or the deque
+void GCMarker::scanScheduled(GCBlockHeader* block) noexcept {
+    if (!m_collectorData.snapshotMarking.load(std::memory_order_relaxed)) {
+        scan(block);
+        return;
+    }
+
+    //the objects of blocks with manually traced pointers, and the blocks with pointers outside of their memory, 
+    //are scanned in the final pause; so are the blocks whose pointer list is modified while it is scanned
+    const GCTypeDescriptor& descriptor = block->descriptor();
+    if (!(descriptor.traits & GCIBlockHeaderVTable::NoScan) || (block->flags.load(std::memory_order_relaxed) & GCBlockHeader::ExternalPtrs) || !scanConcurrently(block)) {
+        defer(block);
+        return;
+    }
+    if (descriptor.traits & GCIBlockHeaderVTable::Traced) {
+        scanLayout(descriptor.layout, block + 1, block->end());
+    }
+}
+
+
+//scans the pointer list of a block while the mutators run
+bool GCMarker::scanConcurrently(const GCBlockHeader* block) noexcept {
+    //the pointer list of a block is not modified after construction, unless member pointers are destroyed explicitly,
+    //e.g. by resetting an optional member; then the links followed might lead out of the block, 
+    //and the list is not scanned further
+    const uintptr_t start = reinterpret_cast<uintptr_t>(block + 1);
+    const uintptr_t end = reinterpret_cast<uintptr_t>(block->end());
+    for (const GCPtrStruct* ptr = GCPtrAccess::load(block->ptrs.next); ptr != block->ptrs.end(); ptr = GCPtrAccess::load(ptr->next)) {
+        if (reinterpret_cast<uintptr_t>(ptr) < start || reinterpret_cast<uintptr_t>(ptr) >= end) {
+            return false;
+        }
+        scan(GCPtrAccess::load(ptr->value));
+    }
+    return true;
+}
+
+
+//defers the scanning of a block to the final pause; if the block cannot be deferred, it is scanned when the marked blocks are rescanned
+void GCMarker::defer(GCBlockHeader* block) noexcept {
+    try {
+        m_deferredBlocks.push_back(block);
+    }
+    catch (...) {
+        m_deferredBlocksOverflow = true;
+    }
+}
+
+
+//scans the pointers found at the offsets of a pointer layout
+void GCMarker::scanLayout(const GCPtrLayout& layout, void* start, void* end) noexcept {
+    //arrays of pointers are scanned in batches
+    if (layout.count == 1 && layout.offsets[0] == 0 && layout.stride == sizeof(void*)) {
+        scan(reinterpret_cast<const void* const*>(start), static_cast<size_t>(reinterpret_cast<char*>(end) - reinterpret_cast<char*>(start)) / sizeof(void*));
+        return;
+    }
+
+    for (char* obj = reinterpret_cast<char*>(start); obj + layout.stride <= end; obj += layout.stride) {
+        for (size_t index = 0; index < layout.count; ++index) {
+            scan(GCPtrAccess::load(*reinterpret_cast<void**>(obj + layout.offsets[index])));
+        }
+    }
+}
+
+
+//moves blocks from the stack to the deque, if the deque is empty
+void GCMarker::share() noexcept {
+    if (m_stack.size() < 2 || !m_deque.empty() || m_collectorData.markers.size() < 2) {
+        return;
+    }
+    for (size_t count = std::min(m_stack.size() / 2, MaxShareCount); count > 0; --count) {
+        if (!m_deque.push(m_stack.pop())) {
+            break;
+        }
+    }
+}
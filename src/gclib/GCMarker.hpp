@@ -0,0 +1,200 @@
+#ifndef GCLIB_GCMARKER_HPP
+#define GCLIB_GCMARKER_HPP
+
+
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include "gclib/GCPtrStruct.hpp"
+#include "gclib/GCTrace.hpp"
+#include "gclib/GCTracer.hpp"
+#include "gclib/GCList.hpp"
+#include "GCMarkStack.hpp"
+#include "GCMarkDeque.hpp"
+#include "GCPrefetchQueue.hpp"
+#include "GCShadowStack.hpp"
+
+
+class GCCollectorData;
+class GCBlockHeader;
+
+
+/**
+ * Per-thread marking state.
+ *
+ * Each marker scans blocks from its private mark stack; when its deque is empty,
+ * it moves some of the blocks of its stack to its deque, so as that idle markers can steal them.
+ * The blocks taken from the stack or the deque pass through a small queue, and their memory is prefetched
+ * a number of blocks before they are scanned (see GC::setPrefetchDistance).
+ */
+class GCMarker {
+public:
+    ///marker of the current thread; set while the thread marks blocks.
+    static thread_local GCMarker* current;
+
+    ///number of bytes of the blocks marked by this marker.
+    size_t markedSize{ 0 };
+
+    /**
+     * Constructor.
+     * @param collectorData the collector data.
+     */
+    GCMarker(GCCollectorData& collectorData) noexcept;
+
+    GCMarker(const GCMarker&) = delete;
+    GCMarker& operator = (const GCMarker&) = delete;
+
+    /**
+     * Marks a block as reachable; if it was not marked before, it is scheduled for scanning.
+     * @param block block to mark.
+     */
+    void mark(GCBlockHeader* block) noexcept;
+
+    /**
+     * Marks the block a pointer points to, if any.
+     * @param value pointer value.
+     */
+    void scan(void* value) noexcept;
+
+    /**
+     * Marks the blocks an array of pointers point to.
+     * @param values pointer values.
+     * @param count number of pointer values.
+     */
+    void scan(const void* const* values, size_t count) noexcept;
+
+    /**
+     * Scans a pointer list.
+     * @param ptrs pointer list.
+     */
+    void scan(const GCList<GCPtrStruct>& ptrs) noexcept;
+
+    /**
+     * Scans the slots of a shadow stack.
+     * @param shadowStack shadow stack.
+     */
+    void scan(const GCShadowStack& shadowStack) noexcept;
+
+    /**
+     * Scans the member pointers of a block.
+     * @param block block to scan.
+     */
+    void scan(GCBlockHeader* block) noexcept;
+
+    /**
+     * Scans the member pointers of an old block during a young collection.
+     * @param block old block to scan.
+     * @return true if the block points to young blocks, false otherwise.
+     */
+    bool scanOld(GCBlockHeader* block) noexcept;
+
+    /**
+     * Scans blocks until this marker has no more blocks to scan.
+     * While blocks are marked along with the mutators, pointer lists and values are read without locking,
+     * and blocks with manually traced pointers are deferred to the final pause, since their objects might be modified.
+     */
+    void drain() noexcept;
+
+    /**
+     * Scans blocks until this marker has no more blocks to scan or until the given deadline passes.
+     * @param deadline time after which no more blocks are scanned.
+     * @return true if there are no more blocks to scan, false otherwise.
+     */
+    bool drain(std::chrono::steady_clock::time_point deadline) noexcept;
+
+    /**
+     * Scans the values recorded by the snapshot barrier, then scans blocks until there are no more blocks to scan.
+     * @return true if any values were recorded, false otherwise.
+     */
+    bool drainOverwrittenPtrs() noexcept;
+
+    /**
+     * Scans the values recorded by the snapshot barrier, then scans blocks until there are no more blocks to scan 
+     * or until the given deadline passes.
+     * @param deadline time after which no more blocks are scanned.
+     * @return true if there are no more blocks to scan, false otherwise.
+     */
+    bool drainOverwrittenPtrs(std::chrono::steady_clock::time_point deadline) noexcept;
+
+    /**
+     * Scans the blocks deferred while blocks were marked along with the mutators; the threads must be stopped.
+     */
+    void scanDeferredBlocks() noexcept;
+
+    /**
+     * Steals a block from another marker; invoked when this marker has no more blocks to scan.
+     * It returns when a block is stolen or when all markers have run out of work.
+     * @param markers all markers.
+     * @param activeMarkers number of markers that have work; shared by all markers.
+     * @return true if a block was stolen, false if marking is complete.
+     */
+    bool steal(const std::vector<std::unique_ptr<GCMarker>>& markers, std::atomic<size_t>& activeMarkers) noexcept;
+
+    /**
+     * Checks if a marked block could not be scheduled for scanning due to mark stack overflow.
+     * @return true if the mark stack overflowed.
+     */
+    bool overflow() const noexcept;
+
+    /**
+     * Resets the overflow flag.
+     */
+    void resetOverflow() noexcept;
+
+private:
+    //the collector data
+    GCCollectorData& m_collectorData;
+
+    //tracer passed to the scan functions of manually traced objects
+    GCTracer m_tracer{ *this };
+
+    //private blocks to scan
+    GCMarkStack m_stack;
+
+    //blocks to scan that can be stolen by other markers
+    GCMarkDeque m_deque;
+
+    //blocks taken from the stack or the deque, whose memory is prefetched before they are scanned
+    GCPrefetchQueue m_prefetchQueue;
+
+    //prefetch distance; read from the collector data at the start of each drain
+    size_t m_prefetchDistance{ 0 };
+
+    //set when a pointer to a young block is scanned
+    bool m_youngFound{ false };
+
+    //blocks marked while marking along with the mutators that are scanned in the final pause
+    std::vector<GCBlockHeader*> m_deferredBlocks;
+
+    //set if a block could not be deferred
+    bool m_deferredBlocksOverflow{ false };
+
+    //returns the next block to scan, or null if there are no more blocks to scan
+    GCBlockHeader* next() noexcept;
+
+    //prefetches the cache lines of the pointer slots of a block
+    void prefetchPtrs(GCBlockHeader* block) noexcept;
+
+    //scans a block taken from the stack or the deque
+    void scanScheduled(GCBlockHeader* block) noexcept;
+
+    //scans the pointer list of a block while the mutators run; returns false if the list was modified while it was scanned
+    bool scanConcurrently(const GCBlockHeader* block) noexcept;
+
+    //defers the scanning of a block to the final pause
+    void defer(GCBlockHeader* block) noexcept;
+
+    //scans the pointers of the objects of a block found at the offsets of a pointer layout
+    void scanLayout(const GCPtrLayout& layout, void* start, void* end) noexcept;
+
+    //marks the blocks the values recorded by the snapshot barrier point to
+    bool scanOverwrittenPtrs() noexcept;
+
+    //if the deque is empty, it moves blocks from the stack to the deque
+    void share() noexcept;
+};
+
+
+#endif //GCLIB_GCMARKER_HPP
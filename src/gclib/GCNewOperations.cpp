@@ -4,24 +4,36 @@
 
 
 //internal register allocation
-template <class F> static void* registerAllocationInternal(size_t size, void* mem, GCIBlockHeaderVTable& vtable, GCList<GCPtrStruct>*& prevPtrList, F&& func) {
+template <class F> static void* registerAllocationInternal(size_t size, void* mem, uint16_t typeId, GCList<GCPtrStruct>*& prevPtrList, F&& func) {
     //get block
     GCBlockHeader* block = reinterpret_cast<GCBlockHeader*>(mem);
 
     GCThread& thread = GCThread::instance();
 
     //init the block
-    new (block) GCBlockHeader(size, vtable, thread.data);
+    new (block) GCBlockHeader(size, typeId);
 
     //add the block to the thread
     thread.blocks.append(block);
 
+    //add the block to the index of blocks, so as that pointers to it can be located
+    GCCollectorData& collectorData = GCCollectorData::instance();
+    collectorData.pageMap.insert(block);
+
+    //while marking along with the mutators, new blocks are allocated marked, since the markers might not reach them
+    if (collectorData.snapshotMarking.load(std::memory_order_relaxed)) {
+        collectorData.pageMap.mark(block, collectorData.cycle);
+        collectorData.markedAllocSize.fetch_add(size, std::memory_order_relaxed);
+    }
+
     //override the ptr list
     prevPtrList = thread.ptrs;
     thread.ptrs = &block->ptrs;
 
-    //increment the global allocation size
-    GCCollectorData::instance().allocSize.fetch_add(size, std::memory_order_relaxed);
+    //count the allocation in the thread's allocation size; 
+    //the counter is written only by this thread, and therefore it is not atomically incremented
+    thread.data->allocSize.store(thread.data->allocSize.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+    thread.data->unsharedAllocSize += size;
 
     //invoke the extra function
     func(thread, block);
@@ -31,12 +43,38 @@ template <class F> static void* registerAllocationInternal(size_t size, void* me
 }
 
 
+//sweeps a few of the blocks queued for lazy sweeping
+void GCNewOperations::sweepQueuedBlocks() {
+    //do not run finalizers in the middle of another allocation, i.e. from within a constructor of a gc object
+    if (GCThread::instance().data->regionDepth.load(std::memory_order_relaxed) > 0) {
+        return;
+    }
+    GCCollectorData::instance().sweeper.sweepQueued(GCSweeper::AllocationSweepCount);
+}
+
+
 //if the allocation limit is exceeded, then collect garbage
 void GCNewOperations::collectGarbageIfAllocationLimitIsExceeded() {    
+    GCThread& thread = GCThread::instance();
+    GCThreadData* data = thread.data;
     GCCollectorData& collectorData = GCCollectorData::instance();
-    
-    //get the current allocation size and limit
-    const size_t allocSize = collectorData.allocSize.load(std::memory_order_acquire);
+    size_t allocSize;
+
+    //the collector resets the counter of the thread, and therefore the counter is accessed within a region
+    thread.enterRegion();
+
+    //while the thread has not exhausted its allocation budget, do not access the shared data
+    if (data->unsharedAllocSize < GCThread::AllocBudget) {
+        thread.leaveRegion();
+        return;
+    }
+
+    //add the allocations of the thread to the allocation size
+    allocSize = collectorData.allocSize.fetch_add(data->unsharedAllocSize, std::memory_order_acq_rel) + data->unsharedAllocSize;
+    data->unsharedAllocSize = 0;
+    thread.leaveRegion();
+
+    //get the allocation limit
     const size_t allocLimit = collectorData.allocLimit.load(std::memory_order_acquire);
 
     //if the allocation size has not yet exceeded the allocation limit, do nothing else
@@ -78,9 +116,15 @@ size_t GCNewOperations::getBlockHeaderSize() {
 }
 
 
+//returns the maximum block size
+size_t GCNewOperations::getMaxBlockSize() {
+    return GCBlockHeader::MaxSize;
+}
+
+
 //register gc memory
-void* GCNewOperations::registerAllocation(size_t size, void* mem, GCIBlockHeaderVTable& vtable, GCList<GCPtrStruct>*& prevPtrList) {
-    return registerAllocationInternal(size, mem, vtable, prevPtrList, [](GCThread& thread, GCBlockHeader* block) {});
+void* GCNewOperations::registerAllocation(size_t size, void* mem, uint16_t typeId, GCList<GCPtrStruct>*& prevPtrList) {
+    return registerAllocationInternal(size, mem, typeId, prevPtrList, [](GCThread& thread, GCBlockHeader* block) {});
 }
 
 
@@ -90,3 +134,19 @@ void GCNewOperations::setPtrList(GCList<GCPtrStruct>* ptrList) {
 }
 
 
+//ends the construction of the objects of a block
+void GCNewOperations::endConstruction(void* mem, GCList<GCPtrStruct>* prevPtrList) {
+    GCBlockHeader* block = reinterpret_cast<GCBlockHeader*>(mem);
+    GCThread::instance().ptrs = prevPtrList;
+
+    //pointers registered to the block that are not within its memory are flagged, 
+    //since they might be destroyed while the markers scan the pointer list of the block
+    const uintptr_t start = reinterpret_cast<uintptr_t>(block + 1);
+    const uintptr_t end = reinterpret_cast<uintptr_t>(block->end());
+    for (GCPtrStruct* ptr = block->ptrs.first(); ptr != block->ptrs.end(); ptr = ptr->next) {
+        if (reinterpret_cast<uintptr_t>(ptr) < start || reinterpret_cast<uintptr_t>(ptr) >= end) {
+            block->flags.fetch_or(GCBlockHeader::ExternalPtrs, std::memory_order_relaxed);
+            break;
+        }
+    }
+}
@@ -0,0 +1,435 @@
+#include <algorithm>
+#include <iterator>
+#include "GCPageMap.hpp"
+#include "GCArena.hpp"
+#include "GCBlockHeader.hpp"
+
+
+//candidate pointers are filtered with AVX2 if enabled by the compiler, otherwise with SSE2, which all x64 processors have
+#if (defined(__x86_64__) || defined(_M_X64)) && !defined(GCLIB_NO_SIMD)
+#ifdef __AVX2__
+#define GCLIB_FILTER_AVX2
+#include <immintrin.h>
+#else
+#define GCLIB_FILTER_SSE2
+#include <emmintrin.h>
+#endif
+#endif
+
+
+static_assert(GCArena::PageSize == size_t(1) << 16, "page map granularity must be the arena page size");
+
+
+//the default constructor
+GCPageMap::GCPageMap() noexcept {
+}
+
+
+//deletes the tree nodes
+GCPageMap::~GCPageMap() {
+    for (std::atomic<Leaf*>& rootEntry : m_root) {
+        Leaf* leaf = rootEntry.load(std::memory_order_acquire);
+        if (!leaf) {
+            continue;
+        }
+        for (size_t index = 0; index < std::size(leaf->entries); ++index) {
+            const uintptr_t value = leaf->entries[index].load(std::memory_order_acquire);
+            const uintptr_t page = (static_cast<uintptr_t>(&rootEntry - m_root) << LeafBits | index) << PageBits;
+
+            //block entries are shared by the pages their block overlaps, and therefore they are deleted with the page their block starts at
+            auto deleteEntry = [&](BlockEntry* entry) {
+                if ((reinterpret_cast<uintptr_t>(entry->block) & ~(GCArena::PageSize - 1)) == page) {
+                    delete entry;
+                }
+            };
+            if (value & BlockTag) {
+                deleteEntry(reinterpret_cast<BlockEntry*>(value & ~TagMask));
+            }
+            else if (value & BucketTag) {
+                Bucket* bucket = reinterpret_cast<Bucket*>(value & ~TagMask);
+                for (BlockEntry* entry : bucket->entries) {
+                    deleteEntry(entry);
+                }
+                delete bucket;
+            }
+        }
+        delete leaf;
+    }
+    endCollection();
+}
+
+
+//registers an arena page
+void GCPageMap::insertArenaPage(void* page) {
+    std::lock_guard lock(m_mutex);
+    getEntry(reinterpret_cast<uintptr_t>(page)).store(reinterpret_cast<uintptr_t>(page), std::memory_order_release);
+    extendAddressRange(reinterpret_cast<uintptr_t>(page), reinterpret_cast<uintptr_t>(page) + GCArena::PageSize);
+}
+
+
+//unregisters an arena page
+void GCPageMap::removeArenaPage(void* page) {
+    std::lock_guard lock(m_mutex);
+    getEntry(reinterpret_cast<uintptr_t>(page)).store(0, std::memory_order_release);
+}
+
+
+//registers a block that is not allocated from an arena page
+void GCPageMap::insert(GCBlockHeader* block) {
+    const uintptr_t start = reinterpret_cast<uintptr_t>(block);
+    const uintptr_t end = reinterpret_cast<uintptr_t>(block->end());
+
+    std::lock_guard lock(m_mutex);
+
+    //if the block is allocated from an arena page, there is nothing to do
+    const uintptr_t value = getEntry(start).load(std::memory_order_relaxed);
+    if (value && !(value & TagMask)) {
+        return;
+    }
+
+    //the pages only the block overlaps point to its entry; the other pages get a new bucket that includes it
+    BlockEntry* blockEntry = new BlockEntry{ block, 0 };
+    extendAddressRange(start, end);
+    for (uintptr_t page = start >> PageBits; page <= (end - 1) >> PageBits; ++page) {
+        std::atomic<uintptr_t>& entry = getEntry(page << PageBits);
+        const uintptr_t pageValue = entry.load(std::memory_order_relaxed);
+        if (!pageValue) {
+            entry.store(reinterpret_cast<uintptr_t>(blockEntry) | BlockTag, std::memory_order_release);
+            continue;
+        }
+        Bucket* bucket = new Bucket;
+        if (pageValue & BlockTag) {
+            bucket->entries.push_back(reinterpret_cast<BlockEntry*>(pageValue & ~TagMask));
+        }
+        else {
+            bucket->entries = reinterpret_cast<Bucket*>(pageValue & ~TagMask)->entries;
+        }
+        auto it = std::upper_bound(bucket->entries.begin(), bucket->entries.end(), block, [](GCBlockHeader* block, const BlockEntry* entry) {
+            return block < entry->block;
+        });
+        bucket->entries.insert(it, blockEntry);
+        entry.store(reinterpret_cast<uintptr_t>(bucket) | BucketTag, std::memory_order_release);
+        if (pageValue & BucketTag) {
+            retire(reinterpret_cast<Bucket*>(pageValue & ~TagMask));
+        }
+    }
+}
+
+
+//unregisters a block that is not allocated from an arena page
+void GCPageMap::remove(GCBlockHeader* block) {
+    const uintptr_t start = reinterpret_cast<uintptr_t>(block);
+    const uintptr_t end = reinterpret_cast<uintptr_t>(block->end());
+
+    std::lock_guard lock(m_mutex);
+
+    //if the block is allocated from an arena page, there is nothing to do
+    const uintptr_t value = getEntry(start).load(std::memory_order_relaxed);
+    if (!(value & TagMask)) {
+        return;
+    }
+
+    //remove the entry of the block from the pages it overlaps; 
+    //a bucket that is left with one entry is replaced by the entry
+    BlockEntry* blockEntry = getBlockEntry(value, block);
+    for (uintptr_t page = start >> PageBits; page <= (end - 1) >> PageBits; ++page) {
+        std::atomic<uintptr_t>& entry = getEntry(page << PageBits);
+        const uintptr_t pageValue = entry.load(std::memory_order_relaxed);
+        if (pageValue & BlockTag) {
+            entry.store(0, std::memory_order_release);
+            continue;
+        }
+        Bucket* oldBucket = reinterpret_cast<Bucket*>(pageValue & ~TagMask);
+        if (oldBucket->entries.size() == 2) {
+            BlockEntry* other = oldBucket->entries[oldBucket->entries[0] == blockEntry ? 1 : 0];
+            entry.store(reinterpret_cast<uintptr_t>(other) | BlockTag, std::memory_order_release);
+        }
+        else {
+            Bucket* bucket = new Bucket;
+            bucket->entries.reserve(oldBucket->entries.size() - 1);
+            std::remove_copy(oldBucket->entries.begin(), oldBucket->entries.end(), std::back_inserter(bucket->entries), blockEntry);
+            entry.store(reinterpret_cast<uintptr_t>(bucket) | BucketTag, std::memory_order_release);
+        }
+        retire(oldBucket);
+    }
+    retire(blockEntry);
+}
+
+
+//starts a collection
+void GCPageMap::beginCollection() {
+    std::lock_guard lock(m_mutex);
+    m_collecting = true;
+}
+
+
+//ends a collection
+void GCPageMap::endCollection() {
+    std::lock_guard lock(m_mutex);
+    m_collecting = false;
+    for (BlockEntry* entry : m_retiredEntries) {
+        delete entry;
+    }
+    m_retiredEntries.clear();
+    for (Bucket* bucket : m_retiredBuckets) {
+        delete bucket;
+    }
+    m_retiredBuckets.clear();
+}
+
+
+//finds the block that contains the given address
+GCBlockHeader* GCPageMap::find(void* addr) const noexcept {
+    //locate the page entry
+    const std::atomic<uintptr_t>* entry = findEntry(reinterpret_cast<uintptr_t>(addr));
+    if (!entry) {
+        return nullptr;
+    }
+    const uintptr_t value = entry->load(std::memory_order_acquire);
+    if (!value) {
+        return nullptr;
+    }
+
+    //arena page; the block is the slot that contains the address, if the slot is allocated
+    if (!(value & TagMask)) {
+        GCBlockHeader* block = reinterpret_cast<GCBlockHeader*>(GCArena::findSlot(reinterpret_cast<void*>(value), addr));
+        if (block && addr >= block + 1 && addr < block->end()) {
+            return block;
+        }
+        return nullptr;
+    }
+
+    //the one block that overlaps the page
+    if (value & BlockTag) {
+        GCBlockHeader* block = reinterpret_cast<const BlockEntry*>(value & ~TagMask)->block;
+        if (addr >= block + 1 && addr < block->end()) {
+            return block;
+        }
+        return nullptr;
+    }
+
+    //bucket
+    return find(*reinterpret_cast<const Bucket*>(value & ~TagMask), addr);
+}
+
+
+//copies the values that might point to blocks
+size_t GCPageMap::filter(const void* const* values, size_t count, void** result) const noexcept {
+    const uintptr_t low = m_lowAddress.load(std::memory_order_acquire);
+    const uintptr_t high = m_highAddress.load(std::memory_order_acquire);
+    size_t resultCount = 0;
+    size_t index = 0;
+
+    //no pages registered
+    if (low >= high) {
+        return 0;
+    }
+
+#if defined(GCLIB_FILTER_AVX2)
+    //four values at once; user space addresses are below 2^63, and therefore they can be compared as signed integers,
+    //while values above 2^63 are negative, i.e. below the low bound
+    const __m256i lowBound = _mm256_set1_epi64x(static_cast<long long>(low) - 1);
+    const __m256i highBound = _mm256_set1_epi64x(static_cast<long long>(high));
+    for (; index + 4 <= count; index += 4) {
+        const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + index));
+        const __m256i inRange = _mm256_and_si256(_mm256_cmpgt_epi64(value, lowBound), _mm256_cmpgt_epi64(highBound, value));
+        const int mask = _mm256_movemask_pd(_mm256_castsi256_pd(inRange));
+        for (int lane = 0; mask >> lane; ++lane) {
+            if (mask & (1 << lane)) {
+                result[resultCount++] = const_cast<void*>(values[index + lane]);
+            }
+        }
+    }
+#elif defined(GCLIB_FILTER_SSE2)
+    //two values at once; SSE2 has no 64-bit comparison, and therefore the page distance from the low bound is computed,
+    //which is in range if its high half is zero and its low half is less than the page count (compared as unsigned)
+    const uintptr_t pageCount = (high - low) >> PageBits;
+    if (pageCount < (uintptr_t(1) << 31)) {
+        const __m128i lowBound = _mm_set1_epi64x(static_cast<long long>(low));
+        const __m128i bias = _mm_set1_epi32(INT32_MIN);
+        const __m128i pageCountBound = _mm_xor_si128(_mm_set1_epi32(static_cast<int>(pageCount)), bias);
+        const __m128i zero = _mm_setzero_si128();
+        for (; index + 2 <= count; index += 2) {
+            const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + index));
+            const __m128i page = _mm_srli_epi64(_mm_sub_epi64(value, lowBound), PageBits);
+            const int lowMask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(_mm_xor_si128(page, bias), pageCountBound)));
+            const int highMask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(page, zero)));
+            const int mask = lowMask & (highMask >> 1);
+            if (mask & 1) {
+                result[resultCount++] = const_cast<void*>(values[index]);
+            }
+            if (mask & 4) {
+                result[resultCount++] = const_cast<void*>(values[index + 1]);
+            }
+        }
+    }
+#endif
+
+    //remaining values
+    for (; index < count; ++index) {
+        if (reinterpret_cast<uintptr_t>(values[index]) - low < high - low) {
+            result[resultCount++] = const_cast<void*>(values[index]);
+        }
+    }
+
+    return resultCount;
+}
+
+
+//marks a block as reachable
+bool GCPageMap::mark(GCBlockHeader* block, size_t cycle) noexcept {
+    const uintptr_t value = findEntry(reinterpret_cast<uintptr_t>(block))->load(std::memory_order_acquire);
+
+    //arena page; set the bit of the block's slot
+    if (!(value & TagMask)) {
+        return GCArena::mark(reinterpret_cast<void*>(value), block);
+    }
+
+    //set the cycle of the block's entry; the check before the modification avoids writing to entries of marked blocks
+    std::atomic<size_t>& entryCycle = getBlockEntry(value, block)->cycle;
+    if (entryCycle.load(std::memory_order_relaxed) == cycle) {
+        return false;
+    }
+    return entryCycle.exchange(cycle, std::memory_order_relaxed) != cycle;
+}
+
+
+//checks if a block is marked as reachable
+bool GCPageMap::isMarked(GCBlockHeader* block, size_t cycle) const noexcept {
+    const uintptr_t value = findEntry(reinterpret_cast<uintptr_t>(block))->load(std::memory_order_acquire);
+
+    //arena page; check the bit of the block's slot
+    if (!(value & TagMask)) {
+        return GCArena::isMarked(reinterpret_cast<void*>(value), block);
+    }
+
+    //check the cycle of the block's entry
+    return getBlockEntry(value, block)->cycle.load(std::memory_order_relaxed) == cycle;
+}
+
+
+//checks if a block is allocated from an arena page
+bool GCPageMap::isArenaBlock(GCBlockHeader* block) const noexcept {
+    return !(findEntry(reinterpret_cast<uintptr_t>(block))->load(std::memory_order_acquire) & TagMask);
+}
+
+
+//marks dirty the card that contains an address
+void GCPageMap::markCard(void* addr) const noexcept {
+    //locate the page entry
+    const std::atomic<uintptr_t>* entry = findEntry(reinterpret_cast<uintptr_t>(addr));
+    if (!entry) {
+        return;
+    }
+
+    //only arena pages have cards; other blocks are scanned at each young collection
+    const uintptr_t value = entry->load(std::memory_order_acquire);
+    if (value && !(value & TagMask)) {
+        GCArena::markCard(reinterpret_cast<void*>(value), addr);
+    }
+}
+
+
+//extends the address range of the registered pages
+void GCPageMap::extendAddressRange(uintptr_t start, uintptr_t end) noexcept {
+    const uintptr_t pageStart = start & ~(GCArena::PageSize - 1);
+    const uintptr_t pageEnd = (end + GCArena::PageSize - 1) & ~(GCArena::PageSize - 1);
+    if (pageStart < m_lowAddress.load(std::memory_order_relaxed)) {
+        m_lowAddress.store(pageStart, std::memory_order_release);
+    }
+    if (pageEnd > m_highAddress.load(std::memory_order_relaxed)) {
+        m_highAddress.store(pageEnd, std::memory_order_release);
+    }
+}
+
+
+//returns the entry of a page
+std::atomic<uintptr_t>& GCPageMap::getEntry(uintptr_t address) {
+    std::atomic<Leaf*>& rootEntry = m_root[address >> (PageBits + LeafBits)];
+    Leaf* leaf = rootEntry.load(std::memory_order_relaxed);
+    if (!leaf) {
+        leaf = new Leaf();
+        rootEntry.store(leaf, std::memory_order_release);
+    }
+    return leaf->entries[(address >> PageBits) & ((size_t(1) << LeafBits) - 1)];
+}
+
+
+//returns the entry of a page or null if the leaf node does not exist
+const std::atomic<uintptr_t>* GCPageMap::findEntry(uintptr_t address) const noexcept {
+
+    //the address is outside of the address range covered by the map
+    if constexpr (AddressBits < sizeof(uintptr_t) * 8) {
+        if (address >> AddressBits) {
+            return nullptr;
+        }
+    }
+
+    //locate the leaf node
+    const Leaf* leaf = m_root[address >> (PageBits + LeafBits)].load(std::memory_order_acquire);
+    if (!leaf) {
+        return nullptr;
+    }
+
+    //locate the page entry
+    return &leaf->entries[(address >> PageBits) & ((size_t(1) << LeafBits) - 1)];
+}
+
+
+//finds a block in a bucket
+GCBlockHeader* GCPageMap::find(const Bucket& bucket, void* addr) noexcept {
+
+    //find block with address greater than the given one
+    auto it = std::upper_bound(bucket.entries.begin(), bucket.entries.end(), addr, [](void* addr, const BlockEntry* entry) {
+        return addr < entry->block;
+    });
+
+    //if the result points to the first block, the address points below the blocks of the bucket
+    if (it == bucket.entries.begin()) {
+        return nullptr;
+    }
+
+    //if the pointer points inside the previous block, then return the block
+    GCBlockHeader* block = (*(it - 1))->block;
+    if (addr >= block + 1 && addr < block->end()) {
+        return block;
+    }
+
+    //not found
+    return nullptr;
+}
+
+
+//returns the entry of a block
+GCPageMap::BlockEntry* GCPageMap::getBlockEntry(uintptr_t value, GCBlockHeader* block) noexcept {
+    if (value & BlockTag) {
+        return reinterpret_cast<BlockEntry*>(value & ~TagMask);
+    }
+    const Bucket* bucket = reinterpret_cast<const Bucket*>(value & ~TagMask);
+    auto it = std::lower_bound(bucket->entries.begin(), bucket->entries.end(), block, [](const BlockEntry* entry, GCBlockHeader* block) {
+        return entry->block < block;
+    });
+    return *it;
+}
+
+
+//deletes an entry or keeps it until the collection ends
+void GCPageMap::retire(BlockEntry* entry) {
+    if (m_collecting) {
+        m_retiredEntries.push_back(entry);
+    }
+    else {
+        delete entry;
+    }
+}
+
+
+//deletes a bucket or keeps it until the collection ends
+void GCPageMap::retire(Bucket* bucket) {
+    if (m_collecting) {
+        m_retiredBuckets.push_back(bucket);
+    }
+    else {
+        delete bucket;
+    }
+}
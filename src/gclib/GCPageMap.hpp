@@ -0,0 +1,217 @@
+#ifndef GCLIB_GCPAGEMAP_HPP
+#define GCLIB_GCPAGEMAP_HPP
+
+
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+
+class GCBlockHeader;
+
+
+/**
+ * Index from addresses to blocks.
+ *
+ * It is a two-level radix tree over the address space, at the granularity of an arena page.
+ * An entry either points to an arena page, in which the block is found in constant time from the slot size,
+ * or to the entry of the one block that is not allocated from an arena and overlaps the page,
+ * or to a bucket of the entries of the blocks that are not allocated from an arena and overlap the page.
+ *
+ * Lookups and marking do not lock: buckets are not modified after they are published;
+ * modifications replace them under lock, and the replaced buckets and the entries of removed blocks
+ * are deleted when no collection is in progress, since only the collection reads the map.
+ *
+ * It is updated as blocks/pages are allocated and freed, so as that the collector
+ * does not have to gather and sort all blocks before marking.
+ *
+ * It also keeps the address range of the registered pages, so as that batches of candidate pointers
+ * can be filtered with SIMD instructions before they are looked up; SIMD can be disabled by defining GCLIB_NO_SIMD.
+ *
+ * It also keeps the mark state of blocks, outside of the block memory:
+ * blocks of arena pages are marked in the mark bitmap of their page, which is cleared by the arena
+ * before each collection; other blocks are marked with the collection cycle in their entry.
+ */
+class GCPageMap {
+public:
+    ///the default constructor.
+    GCPageMap() noexcept;
+
+    ///deletes the tree nodes.
+    ~GCPageMap();
+
+    GCPageMap(const GCPageMap&) = delete;
+    GCPageMap& operator = (const GCPageMap&) = delete;
+
+    /**
+     * Registers an arena page.
+     * @param page page to register.
+     */
+    void insertArenaPage(void* page);
+
+    /**
+     * Unregisters an arena page.
+     * @param page page to unregister.
+     */
+    void removeArenaPage(void* page);
+
+    /**
+     * Registers a block.
+     * Blocks allocated from arena pages are already known, and therefore nothing is done for them.
+     * @param block block to register.
+     */
+    void insert(GCBlockHeader* block);
+
+    /**
+     * Unregisters a block.
+     * Blocks allocated from arena pages are not registered, and therefore nothing is done for them.
+     * @param block block to unregister.
+     */
+    void remove(GCBlockHeader* block);
+
+    /**
+     * Starts a collection: until it ends, the entries and buckets removed from the map are not deleted,
+     * since they might be read by markers.
+     * It must be invoked before any block is looked up or marked for the collection.
+     */
+    void beginCollection();
+
+    /**
+     * Ends a collection; the entries and buckets removed from the map since the collection started are deleted.
+     * It must be invoked after the blocks are no longer looked up or marked for the collection.
+     */
+    void endCollection();
+
+    /**
+     * Finds the block that contains the given address.
+     * @param addr address.
+     * @return pointer to the block or null if the address does not point to the object memory of a block.
+     */
+    GCBlockHeader* find(void* addr) const noexcept;
+
+    /**
+     * Copies the values that point within the address range of the registered pages, 
+     * i.e. the values that might point to blocks; null values and values outside of the heap are skipped.
+     * It can be invoked from any marker thread.
+     * @param values candidate pointer values.
+     * @param count number of candidate pointer values.
+     * @param result the values that might point to blocks; it must have room for count values.
+     * @return number of values copied to the result.
+     */
+    size_t filter(const void* const* values, size_t count, void** result) const noexcept;
+
+    /**
+     * Marks a block as reachable.
+     * It can be invoked from any marker thread.
+     * @param block block to mark; it must be registered.
+     * @param cycle current collection cycle.
+     * @return true if the block was not marked before, false otherwise.
+     */
+    bool mark(GCBlockHeader* block, size_t cycle) noexcept;
+
+    /**
+     * Checks if a block is marked as reachable.
+     * @param block block to check; it must be registered.
+     * @param cycle current collection cycle.
+     * @return true if the block is marked, false otherwise.
+     */
+    bool isMarked(GCBlockHeader* block, size_t cycle) const noexcept;
+
+    /**
+     * Checks if a block is allocated from an arena page.
+     * @param block block to check; it must be registered.
+     * @return true if the block is allocated from an arena page, false otherwise.
+     */
+    bool isArenaBlock(GCBlockHeader* block) const noexcept;
+
+    /**
+     * Marks dirty the card that contains the given address, if the address is within an arena page.
+     * It can be invoked from any thread.
+     * @param addr address of the modified pointer.
+     */
+    void markCard(void* addr) const noexcept;
+
+private:
+    //number of bits of an address that are significant
+    static constexpr size_t AddressBits = sizeof(void*) == 8 ? 48 : 32;
+
+    //number of bits of page offset; pages are arena pages
+    static constexpr size_t PageBits = 16;
+
+    //number of bits of index in leaf node
+    static constexpr size_t LeafBits = (AddressBits - PageBits) / 2;
+
+    //number of bits of index in root node
+    static constexpr size_t RootBits = AddressBits - PageBits - LeafBits;
+
+    //tag of entries that point to a block entry
+    static constexpr uintptr_t BlockTag = 1;
+
+    //tag of entries that point to buckets
+    static constexpr uintptr_t BucketTag = 2;
+
+    //mask of the tags
+    static constexpr uintptr_t TagMask = BlockTag | BucketTag;
+
+    //entry of a block not allocated from an arena; shared by the pages the block overlaps
+    struct BlockEntry {
+        GCBlockHeader* block;
+
+        //last cycle the block was marked at
+        std::atomic<size_t> cycle;
+    };
+
+    //entries of the blocks that overlap a page, sorted by block address; not modified after it is published
+    struct Bucket {
+        std::vector<BlockEntry*> entries;
+    };
+
+    //leaf node
+    struct Leaf {
+        std::atomic<uintptr_t> entries[size_t(1) << LeafBits];
+    };
+
+    //root node
+    std::atomic<Leaf*> m_root[size_t(1) << RootBits]{};
+
+    //mutex for modifications
+    std::mutex m_mutex;
+
+    //set while a collection is in progress
+    bool m_collecting{ false };
+
+    //entries and buckets removed while a collection is in progress
+    std::vector<BlockEntry*> m_retiredEntries;
+    std::vector<Bucket*> m_retiredBuckets;
+
+    //start of the lowest registered page; it is only decreased
+    std::atomic<uintptr_t> m_lowAddress{ UINTPTR_MAX };
+
+    //end of the highest registered page; it is only increased
+    std::atomic<uintptr_t> m_highAddress{ 0 };
+
+    //extends the address range of the registered pages; must be invoked under lock
+    void extendAddressRange(uintptr_t start, uintptr_t end) noexcept;
+
+    //returns the entry of a page; if the leaf node does not exist, it is created
+    std::atomic<uintptr_t>& getEntry(uintptr_t address);
+
+    //returns the entry of a page or null if the leaf node does not exist
+    const std::atomic<uintptr_t>* findEntry(uintptr_t address) const noexcept;
+
+    //finds a block in a bucket
+    static GCBlockHeader* find(const Bucket& bucket, void* addr) noexcept;
+
+    //returns the entry of the given block, from the map entry of the page the block starts at
+    static BlockEntry* getBlockEntry(uintptr_t value, GCBlockHeader* block) noexcept;
+
+    //deletes an entry, or keeps it until the collection in progress ends; must be invoked under lock
+    void retire(BlockEntry* entry);
+
+    //deletes a bucket, or keeps it until the collection in progress ends; must be invoked under lock
+    void retire(Bucket* bucket);
+};
+
+
+#endif //GCLIB_GCPAGEMAP_HPP
@@ -0,0 +1,125 @@
+#include <new>
+#include <algorithm>
+#include <cstdint>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#include "GCPageSource.hpp"
+
+
+//huge pages flag
+std::atomic<bool> GCPageSource::m_hugePages{ false };
+
+
+//mutex for the region data
+std::mutex GCPageSource::m_mutex;
+
+
+//start addresses of regions
+std::vector<char*> GCPageSource::m_regions;
+
+
+//free pages of regions
+std::vector<void*> GCPageSource::m_freePages;
+
+
+//allocates a page
+void* GCPageSource::allocate(size_t pageSize) noexcept {
+    if (m_hugePages.load(std::memory_order_acquire)) {
+        std::lock_guard lock(m_mutex);
+
+        //if there are no free pages, carve the pages of a new region
+        if (m_freePages.empty()) {
+            char* region = allocateRegion();
+            if (region) {
+                try {
+                    m_regions.insert(std::upper_bound(m_regions.begin(), m_regions.end(), region), region);
+                    for (char* page = region + RegionSize - pageSize; page >= region; page -= pageSize) {
+                        m_freePages.push_back(page);
+                    }
+                }
+                catch (...) {
+                    m_freePages.clear();
+                }
+            }
+        }
+
+        //take a free page; if a region could not be mapped, fall back to the system allocator
+        if (!m_freePages.empty()) {
+            void* page = m_freePages.back();
+            m_freePages.pop_back();
+            return page;
+        }
+    }
+
+    return ::operator new(pageSize, std::align_val_t(pageSize), std::nothrow);
+}
+
+
+//frees a page
+void GCPageSource::free(void* page, size_t pageSize) noexcept {
+    {
+        std::lock_guard lock(m_mutex);
+        if (isRegionPage(page)) {
+            try {
+                m_freePages.push_back(page);
+            }
+            catch (...) {
+                //the page is leaked, but its region is never returned to the system anyway
+            }
+            return;
+        }
+    }
+
+    ::operator delete(page, std::align_val_t(pageSize));
+}
+
+
+//checks if huge pages are enabled
+bool GCPageSource::getHugePages() noexcept {
+    return m_hugePages.load(std::memory_order_acquire);
+}
+
+
+//enables/disables huge pages
+void GCPageSource::setHugePages(bool hugePages) noexcept {
+    m_hugePages.store(hugePages, std::memory_order_release);
+}
+
+
+//maps a new region
+char* GCPageSource::allocateRegion() noexcept {
+#ifdef _WIN32
+    //windows provides large pages only with special privileges; use normal pages, aligned to the region size
+    return reinterpret_cast<char*>(::operator new(RegionSize, std::align_val_t(RegionSize), std::nothrow));
+#else
+    //map twice the region size, then unmap the parts before and after the aligned region
+    char* mem = reinterpret_cast<char*>(mmap(nullptr, 2 * RegionSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (mem == MAP_FAILED) {
+        return nullptr;
+    }
+    char* region = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(mem) + RegionSize - 1) & ~(RegionSize - 1));
+    if (region > mem) {
+        munmap(mem, region - mem);
+    }
+    if (region + RegionSize < mem + 2 * RegionSize) {
+        munmap(region + RegionSize, mem + 2 * RegionSize - (region + RegionSize));
+    }
+
+    //request transparent huge pages; if they are not available, the advice fails, and normal pages are used
+#ifdef MADV_HUGEPAGE
+    madvise(region, RegionSize, MADV_HUGEPAGE);
+#endif
+
+    return region;
+#endif
+}
+
+
+//checks if a page belongs to a region
+bool GCPageSource::isRegionPage(void* page) noexcept {
+    auto it = std::upper_bound(m_regions.begin(), m_regions.end(), reinterpret_cast<char*>(page));
+    return it != m_regions.begin() && reinterpret_cast<char*>(page) < *(it - 1) + RegionSize;
+}
@@ -0,0 +1,74 @@
+#ifndef GCLIB_GCPAGESOURCE_HPP
+#define GCLIB_GCPAGESOURCE_HPP
+
+
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+
+/**
+ * Source of arena pages.
+ *
+ * By default, each page is allocated from the system allocator.
+ * If huge pages are enabled, pages are carved from regions of 2 MB, which are aligned to their size
+ * and advised to be backed by transparent huge pages, so as that the collector, while it follows pointers
+ * from page to page, touches far fewer TLB entries. If the system does not support transparent huge pages,
+ * the regions are backed by normal pages.
+ *
+ * Pages carved from regions are reused when freed; regions are never returned to the system.
+ */
+class GCPageSource {
+public:
+    ///size of region; it is the size of a transparent huge page on x86-64/aarch64 systems.
+    static constexpr size_t RegionSize = 2 * 1024 * 1024;
+
+    /**
+     * Allocates a page.
+     * @param pageSize size of the page; pages are aligned to their size; it must be a divisor of the region size.
+     * @return pointer to the page or null if the system is out of memory.
+     */
+    static void* allocate(size_t pageSize) noexcept;
+
+    /**
+     * Frees a page.
+     * @param page page returned from allocate.
+     * @param pageSize size of the page, as passed to allocate.
+     */
+    static void free(void* page, size_t pageSize) noexcept;
+
+    /**
+     * Checks if pages are allocated from huge page regions.
+     * @return true if huge pages are enabled, false otherwise.
+     */
+    static bool getHugePages() noexcept;
+
+    /**
+     * Enables/disables huge pages; it affects only pages allocated from now on.
+     * @param hugePages if true, pages are allocated from huge page regions.
+     */
+    static void setHugePages(bool hugePages) noexcept;
+
+private:
+    //huge pages flag
+    static std::atomic<bool> m_hugePages;
+
+    //mutex for the members below
+    static std::mutex m_mutex;
+
+    //start addresses of regions
+    static std::vector<char*> m_regions;
+
+    //free pages of regions
+    static std::vector<void*> m_freePages;
+
+    //maps a new region; returns null on failure
+    static char* allocateRegion() noexcept;
+
+    //checks if a page belongs to a region
+    static bool isRegionPage(void* page) noexcept;
+};
+
+
+#endif //GCLIB_GCPAGESOURCE_HPP
@@ -0,0 +1,69 @@
+#ifndef GCLIB_GCPREFETCHQUEUE_HPP
+#define GCLIB_GCPREFETCHQUEUE_HPP
+
+
+#include <cstddef>
+
+
+class GCBlockHeader;
+
+
+/**
+ * Fixed-capacity FIFO queue of blocks to scan.
+ *
+ * The marker puts the blocks it takes from its stack or its deque in the queue, and prefetches their memory;
+ * a block is scanned when it reaches the front of the queue, i.e. after a number of other blocks are scanned,
+ * so as that its memory has been fetched in the meantime.
+ */
+class GCPrefetchQueue {
+public:
+    ///capacity of the queue.
+    static constexpr size_t Capacity = 64;
+
+    ///maximum prefetch distance, i.e. maximum number of blocks kept in the queue before a block is scanned.
+    static constexpr size_t MaxDistance = Capacity / 2;
+
+    /**
+     * Pushes a block at the back of the queue; the queue must not be full.
+     * @param block block to push.
+     */
+    void push(GCBlockHeader* block) noexcept {
+        m_entries[(m_front + m_size) & (Capacity - 1)] = block;
+        ++m_size;
+    }
+
+    /**
+     * Pops the block at the front of the queue.
+     * @return the block at the front of the queue or null if the queue is empty.
+     */
+    GCBlockHeader* pop() noexcept {
+        if (m_size == 0) {
+            return nullptr;
+        }
+        GCBlockHeader* const block = m_entries[m_front];
+        m_front = (m_front + 1) & (Capacity - 1);
+        --m_size;
+        return block;
+    }
+
+    /**
+     * Returns the number of blocks in the queue.
+     * @return the number of blocks in the queue.
+     */
+    size_t size() const noexcept {
+        return m_size;
+    }
+
+private:
+    //queue memory
+    GCBlockHeader* m_entries[Capacity];
+
+    //index of the front of the queue
+    size_t m_front{ 0 };
+
+    //number of blocks in the queue
+    size_t m_size{ 0 };
+};
+
+
+#endif //GCLIB_GCPREFETCHQUEUE_HPP
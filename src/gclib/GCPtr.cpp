@@ -1,31 +1,68 @@
 #include "gclib/GCPtr.hpp"
 #include "GCThread.hpp"
+#include "GCCollectorData.hpp"
+#include "GCPtrAccess.hpp"
+
+
+//appends a ptr to a ptr list; the links are stored atomically, 
+//since the markers might follow the links of the list of a block at the same time
+static void appendPtr(GCList<GCPtrStruct>& list, GCPtrStruct* ptr) {
+    GCPtrStruct* const end = reinterpret_cast<GCPtrStruct*>(static_cast<GCNode<GCPtrStruct>*>(&list));
+    GCPtrAccess::store(ptr->prev, list.prev);
+    GCPtrAccess::store(ptr->next, end);
+    GCPtrAccess::store(list.prev->next, ptr);
+    GCPtrAccess::store(list.prev, ptr);
+}
 
 
 //init ptr, copy source value
 void GCPtrPrivate::initCopy(GCPtrStruct* ptr, void* src) {
     GCThread& thread = GCThread::instance();
-    ptr->value = src;
+    GCPtrAccess::store(ptr->value, src);
     ptr->mutex = &thread.mutex;
-    std::lock_guard lock(thread.mutex);
-    thread.ptrs->append(ptr);
+    thread.enterRegion();
+    {
+        std::lock_guard lock(thread.mutex);
+        appendPtr(*thread.ptrs, ptr);
+    }
+    thread.leaveRegion();
 }
 
 
 //init ptr, move source value
 void GCPtrPrivate::initMove(GCPtrStruct* ptr, void*& src) {
     GCThread& thread = GCThread::instance();
-    ptr->value = src;
+    GCCollectorData& collectorData = GCCollectorData::instance();
+    GCPtrAccess::store(ptr->value, src);
     ptr->mutex = &thread.mutex;
-    std::lock_guard lock(thread.mutex);
-    thread.ptrs->append(ptr);
-    src = nullptr;
+    thread.enterRegion();
+
+    //the source is overwritten; its value is recorded, since the new pointer might be a root created after the roots were scanned
+    if (collectorData.snapshotMarking.load(std::memory_order_relaxed)) {
+        collectorData.recordOverwrittenPtr(*thread.data, src);
+    }
+    {
+        std::lock_guard lock(thread.mutex);
+        appendPtr(*thread.ptrs, ptr);
+    }
+    GCPtrAccess::store(src, static_cast<void*>(nullptr));
+    thread.leaveRegion();
 }
 
 
 //remove ptr from collector
 void GCPtrPrivate::cleanup(GCPtrStruct* ptr) {
     if (!ptr->mutex) return;
+    GCThreadLock region;
+
+    //the value of a removed pointer is overwritten as far as the snapshot barrier is concerned
+    GCCollectorData& collectorData = GCCollectorData::instance();
+    if (collectorData.snapshotMarking.load(std::memory_order_relaxed)) {
+        collectorData.recordOverwrittenPtr(*GCThread::instance().data, ptr->value);
+    }
+
+    //the markers might follow the links of the list of a block at the same time
     std::lock_guard lock(*ptr->mutex);
-    ptr->detach();
+    GCPtrAccess::store(ptr->prev->next, ptr->next);
+    GCPtrAccess::store(ptr->next->prev, ptr->prev);
 }
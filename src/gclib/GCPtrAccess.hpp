@@ -0,0 +1,42 @@
+#ifndef GCLIB_GCPTRACCESS_HPP
+#define GCLIB_GCPTRACCESS_HPP
+
+
+/**
+ * Accesses to pointer slots that the markers read while the mutators write them,
+ * i.e. pointer values and links of pointer lists while blocks are marked along with the mutators.
+ *
+ * The accesses are atomic and relaxed: the markers need not see the latest value of a slot,
+ * since the snapshot barrier records the values the mutators overwrite, but they must not see a torn value.
+ */
+class GCPtrAccess {
+public:
+    /**
+     * Loads the value of a pointer slot.
+     * @param slot slot to load.
+     * @return the value of the slot.
+     */
+    template <class T> static T* load(T* const& slot) noexcept {
+#if defined(__GNUC__)
+        return __atomic_load_n(&slot, __ATOMIC_RELAXED);
+#else
+        return *static_cast<T* const volatile*>(&slot);
+#endif
+    }
+
+    /**
+     * Stores a value to a pointer slot.
+     * @param slot slot to store to.
+     * @param value value to store.
+     */
+    template <class T> static void store(T*& slot, T* value) noexcept {
+#if defined(__GNUC__)
+        __atomic_store_n(&slot, value, __ATOMIC_RELAXED);
+#else
+        *static_cast<T* volatile*>(&slot) = value;
+#endif
+    }
+};
+
+
+#endif //GCLIB_GCPTRACCESS_HPP
@@ -0,0 +1,55 @@
+#include "GCShadowStack.hpp"
+
+
+//the default constructor
+GCShadowStack::GCShadowStack() noexcept : m_first(nullptr), m_chunk(nullptr), m_index(ChunkSize) {
+}
+
+
+//frees the chunks
+GCShadowStack::~GCShadowStack() {
+    for (Chunk* chunk = m_first; chunk;) {
+        Chunk* next = chunk->next;
+        delete chunk;
+        chunk = next;
+    }
+}
+
+
+//pops the top slot, along with any free slots below it
+void GCShadowStack::pop() noexcept {
+    size_t size = m_size.load(std::memory_order_relaxed);
+    do {
+        if (m_index == 0) {
+            m_chunk = m_chunk->prev;
+            m_index = ChunkSize;
+        }
+        --m_index;
+        --size;
+    } while (size > 0 && (m_index > 0 ? m_chunk->slots[m_index - 1] : m_chunk->prev->slots[ChunkSize - 1]).load(std::memory_order_relaxed) == freeValue());
+    m_size.store(size, std::memory_order_release);
+}
+
+
+//moves to the next chunk
+void GCShadowStack::nextChunk() {
+    //the next chunk already exists; chunks are kept, so as that a stack that oscillates around a chunk boundary does not allocate
+    if (m_chunk && m_chunk->next) {
+        m_chunk = m_chunk->next;
+        m_index = 0;
+        return;
+    }
+
+    //allocate a new chunk; it is published to the collector by the size increment in push
+    Chunk* chunk = new Chunk;
+    chunk->prev = m_chunk;
+    chunk->next = nullptr;
+    if (m_chunk) {
+        m_chunk->next = chunk;
+    }
+    else {
+        m_first = chunk;
+    }
+    m_chunk = chunk;
+    m_index = 0;
+}
@@ -0,0 +1,129 @@
+#ifndef GCLIB_GCSHADOWSTACK_HPP
+#define GCLIB_GCSHADOWSTACK_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+
+
+/**
+ * Per-thread stack of root pointer values, used by pointers with automatic storage.
+ *
+ * Slots are pushed and popped by the owner thread without locking; the collector reads the size of the stack
+ * and then scans the slots, which are kept in chunks of contiguous memory.
+ *
+ * Slots that are released out of order are set to a free value; they are removed when they reach the top of the stack.
+ */
+class GCShadowStack {
+public:
+    ///number of slots per chunk.
+    static constexpr size_t ChunkSize = 1024;
+
+    ///the default constructor.
+    GCShadowStack() noexcept;
+
+    ///frees the chunks.
+    ~GCShadowStack();
+
+    GCShadowStack(const GCShadowStack&) = delete;
+    GCShadowStack& operator = (const GCShadowStack&) = delete;
+
+    /**
+     * Pushes a slot.
+     * Must be invoked only from the owner thread.
+     * @param value initial value of the slot.
+     * @return the slot.
+     * @exception std::bad_alloc thrown if a new chunk cannot be allocated.
+     */
+    std::atomic<void*>* push(void* value) {
+        if (m_index == ChunkSize) {
+            nextChunk();
+        }
+        std::atomic<void*>* slot = m_chunk->slots + m_index++;
+        slot->store(value, std::memory_order_relaxed);
+        m_size.store(m_size.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        return slot;
+    }
+
+    /**
+     * Checks if the given slot is the top slot.
+     * @param slot slot.
+     * @return true if the slot is the top slot, false otherwise.
+     */
+    bool isTop(const std::atomic<void*>* slot) const noexcept {
+        return m_index > 0 ? slot == m_chunk->slots + m_index - 1 : slot == m_chunk->prev->slots + ChunkSize - 1;
+    }
+
+    /**
+     * Pops the top slot, along with any free slots below it.
+     * Must be invoked only from the owner thread.
+     */
+    void pop() noexcept;
+
+    /**
+     * Releases a slot that is not the top slot.
+     * The caller must prevent the collector from running while invoking this.
+     * @param slot slot.
+     */
+    static void free(std::atomic<void*>* slot) noexcept {
+        slot->store(freeValue(), std::memory_order_relaxed);
+    }
+
+    /**
+     * Checks if the stack is empty.
+     * @return true if the stack is empty, false otherwise.
+     */
+    bool empty() const noexcept {
+        return m_size.load(std::memory_order_acquire) == 0;
+    }
+
+    /**
+     * Invokes the given function for the values of all slots; free slots are skipped.
+     * @param func function to invoke.
+     */
+    template <class F> void forEach(F&& func) const {
+        size_t size = m_size.load(std::memory_order_acquire);
+        for (const Chunk* chunk = m_first; size > 0; chunk = chunk->next) {
+            const size_t count = size < ChunkSize ? size : ChunkSize;
+            for (size_t index = 0; index < count; ++index) {
+                void* value = chunk->slots[index].load(std::memory_order_relaxed);
+                if (value != freeValue()) {
+                    func(value);
+                }
+            }
+            size -= count;
+        }
+    }
+
+private:
+    //chunk of slots
+    struct Chunk {
+        std::atomic<void*> slots[ChunkSize];
+        Chunk* prev;
+        Chunk* next;
+    };
+
+    //first chunk
+    Chunk* m_first;
+
+    //current chunk
+    Chunk* m_chunk;
+
+    //index of the next slot in the current chunk
+    size_t m_index{ 0 };
+
+    //number of slots; read by the collector
+    std::atomic<size_t> m_size{ 0 };
+
+    //value of free slots
+    static void* freeValue() noexcept {
+        return reinterpret_cast<void*>(uintptr_t(1));
+    }
+
+    //moves to the next chunk; allocates it if it does not exist
+    void nextChunk();
+};
+
+
+#endif //GCLIB_GCSHADOWSTACK_HPP
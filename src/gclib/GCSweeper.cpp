@@ -0,0 +1,264 @@
+#include <vector>
+#include "gclib/GCDeleteOperations.hpp"
+#include "GCSweeper.hpp"
+#include "GCBlockHeader.hpp"
+#include "GCArena.hpp"
+
+
+//the default constructor
+GCSweeper::GCSweeper() noexcept {
+}
+
+
+//stops the background thread
+GCSweeper::~GCSweeper() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_workCond.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+
+//deletes explicitly deleted blocks
+void GCSweeper::deleteBlocks(GCList<GCBlockHeader>& blocks) {
+    for (GCBlockHeader* block = blocks.first(); block != blocks.end();) {
+        GCBlockHeader* next = block->next;
+        block->detach();
+        GCDeleteOperations::deleteBlock(block);
+        block = next;
+    }
+}
+
+
+//sweeps the given blocks
+void GCSweeper::sweep(GCList<GCBlockHeader>& blocks) {
+    //if the sweeper threads are busy (i.e. a finalizer triggered a collection), 
+    //or if there is a single sweeper thread, then sweep the blocks in the current thread
+    std::unique_lock lock(m_workersMutex, std::try_to_lock);
+    const size_t threadCount = lock ? m_workers.getCount() : 1;
+    if (threadCount == 1) {
+        sweepBlocks(blocks);
+        return;
+    }
+
+    //distribute the blocks in a round-robin fashion, so as that each thread gets a similar amount of work
+    std::vector<GCList<GCBlockHeader>> threadBlocks(threadCount);
+    size_t threadIndex = 0;
+    for (GCBlockHeader* block = blocks.first(); block != blocks.end();) {
+        GCBlockHeader* next = block->next;
+        threadBlocks[threadIndex].append(block);
+        threadIndex = (threadIndex + 1) % threadCount;
+        block = next;
+    }
+    blocks.clear();
+
+    //sweep in parallel
+    m_workers.run([&](size_t index) {
+        sweepBlocks(threadBlocks[index]);
+    });
+}
+
+
+//queues the given blocks
+void GCSweeper::add(GCList<GCBlockHeader>&& blocks) {
+    if (blocks.empty()) {
+        return;
+    }
+    {
+        std::lock_guard lock(m_mutex);
+        m_blocks.append(std::move(blocks));
+        m_pending.store(true, std::memory_order_release);
+    }
+    m_workCond.notify_one();
+}
+
+
+//sweeps up to the given number of queued blocks
+size_t GCSweeper::sweepQueued(size_t maxCount) {
+    //no work
+    if (!m_pending.load(std::memory_order_acquire)) {
+        return 0;
+    }
+
+    //take a chunk of blocks from the queue, so as that the finalizers do not run under the lock
+    GCList<GCBlockHeader> blocks = take(maxCount);
+
+    //sweep the chunk in the current thread, since it is small
+    size_t count = 0;
+    for (GCBlockHeader* block = blocks.first(); block != blocks.end(); block = block->next) {
+        ++count;
+    }
+    sweepBlocks(blocks);
+    done();
+    return count;
+}
+
+
+//sweeps all queued blocks
+void GCSweeper::sweepQueued() {
+    GCList<GCBlockHeader> blocks = take(SIZE_MAX);
+    sweep(blocks);
+    done();
+}
+
+
+//waits for the blocks taken from the queue by other threads
+void GCSweeper::wait() {
+    std::unique_lock lock(m_mutex);
+    m_doneCond.wait(lock, [&]() { return m_activeCount == 0; });
+}
+
+
+//checks if lazy sweeping is enabled
+bool GCSweeper::isLazy() const noexcept {
+    return m_lazy.load(std::memory_order_acquire);
+}
+
+
+//enables/disables lazy sweeping
+void GCSweeper::setLazy(bool lazy) noexcept {
+    m_lazy.store(lazy, std::memory_order_release);
+}
+
+
+//checks if background sweeping is enabled
+bool GCSweeper::isBackground() const noexcept {
+    return m_background.load(std::memory_order_acquire);
+}
+
+
+//enables/disables background sweeping
+void GCSweeper::setBackground(bool background) {
+    {
+        std::lock_guard lock(m_mutex);
+        m_background.store(background, std::memory_order_release);
+        if (background && !m_thread.joinable()) {
+            m_thread = std::thread([this]() { run(); });
+        }
+    }
+    m_workCond.notify_one();
+}
+
+
+//returns the number of sweeper threads
+size_t GCSweeper::getThreadCount() {
+    std::lock_guard lock(m_workersMutex);
+    return m_workers.getCount();
+}
+
+
+//sets the number of sweeper threads
+void GCSweeper::setThreadCount(size_t count) {
+    std::lock_guard lock(m_workersMutex);
+    m_workers.setCount(count);
+}
+
+
+//takes blocks from the queue
+GCList<GCBlockHeader> GCSweeper::take(size_t maxCount) {
+    GCList<GCBlockHeader> blocks;
+    std::lock_guard lock(m_mutex);
+
+    //take all blocks
+    if (maxCount == SIZE_MAX) {
+        blocks = std::move(m_blocks);
+    }
+
+    //take a chunk of blocks
+    else {
+        for (size_t count = 0; count < maxCount && !m_blocks.empty(); ++count) {
+            GCBlockHeader* block = m_blocks.first();
+            block->detach();
+            blocks.append(block);
+        }
+    }
+
+    if (m_blocks.empty()) {
+        m_pending.store(false, std::memory_order_release);
+    }
+    ++m_activeCount;
+    return blocks;
+}
+
+
+//marks the end of a sweep of queued blocks
+void GCSweeper::done() {
+    {
+        std::lock_guard lock(m_mutex);
+        --m_activeCount;
+    }
+    m_doneCond.notify_all();
+}
+
+
+//the background thread loop
+void GCSweeper::run() {
+    for (;;) {
+        {
+            std::unique_lock lock(m_mutex);
+            m_workCond.wait(lock, [&]() { return m_stop || (m_background.load(std::memory_order_relaxed) && !m_blocks.empty()); });
+            if (m_stop) {
+                return;
+            }
+        }
+        GCList<GCBlockHeader> blocks = take(SIZE_MAX);
+        sweep(blocks);
+        done();
+    }
+}
+
+
+//sweeps blocks in the current thread
+void GCSweeper::sweepBlocks(GCList<GCBlockHeader>& blocks) {
+    //slots of trivial blocks of the same page, to be freed at once
+    void* batch[FreeBatchSize];
+    size_t batchSize = 0;
+
+    for (GCBlockHeader* block = blocks.first(); block != blocks.end();) {
+        GCBlockHeader* next = block->next;
+
+        //trivial blocks allocated from arenas need no finalization, no pointer reset, no shared check, 
+        //and no page map update; consecutive blocks are usually allocated from the same page
+        if (block->descriptor().traits == GCIBlockHeaderVTable::Trivial && block->size() <= GCArena::MaxSlotSize) {
+            if (batchSize == FreeBatchSize || (batchSize > 0 && !GCArena::isSamePage(batch[0], block))) {
+                GCArena::free(batch, batchSize);
+                batchSize = 0;
+            }
+
+            //mark the slot as free, so as that it is not mistaken for a block
+            block->clearSize();
+            batch[batchSize++] = block;
+        }
+
+        //other blocks
+        else {
+            sweep(block);
+        }
+
+        block = next;
+    }
+
+    GCArena::free(batch, batchSize);
+    blocks.clear();
+}
+
+
+//sweeps a block
+void GCSweeper::sweep(GCBlockHeader* block) {
+    //if the block can be shared via shared pointers, set the collected flag,
+    //and if the block is shared, do not delete it
+    const GCTypeDescriptor& descriptor = block->descriptor();
+    if (!(descriptor.traits & GCIBlockHeaderVTable::NotShareable)) {
+        block->flags.fetch_or(GCBlockHeader::Collected, std::memory_order::memory_order_release);
+        if (descriptor.shared(block + 1, block->end())) {
+            return;
+        }
+    }
+
+    //delete the block
+    GCDeleteOperations::deleteBlock(block);
+}
@@ -0,0 +1,175 @@
+#ifndef GCLIB_GCSWEEPER_HPP
+#define GCLIB_GCSWEEPER_HPP
+
+
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include "gclib/GCList.hpp"
+#include "GCWorkerThreads.hpp"
+
+
+class GCBlockHeader;
+
+
+/**
+ * Sweeps the blocks found unreachable by the collector.
+ *
+ * Blocks can either be swept immediately, or queued, in order to be swept lazily in chunks
+ * by the threads that allocate memory, so as that the cost of finalization is spread over
+ * subsequent allocations instead of being paid by the thread that collects garbage.
+ *
+ * Queued blocks can also be swept by a background thread, in which case collection
+ * returns as soon as the threads are resumed.
+ *
+ * Large lists of blocks are partitioned between a pool of sweeper threads, 
+ * which finalize and free the blocks in parallel.
+ */
+class GCSweeper {
+public:
+    ///number of queued blocks a thread sweeps before each allocation.
+    static constexpr size_t AllocationSweepCount = 8;
+
+    ///the default constructor.
+    GCSweeper() noexcept;
+
+    ///stops the background thread.
+    ~GCSweeper();
+
+    GCSweeper(const GCSweeper&) = delete;
+    GCSweeper& operator = (const GCSweeper&) = delete;
+
+    /**
+     * Sweeps the given blocks, in parallel if there are multiple sweeper threads
+     * and the sweeper threads are not busy with another list of blocks.
+     * @param blocks unreachable blocks; the list is emptied.
+     */
+    void sweep(GCList<GCBlockHeader>& blocks);
+
+    /**
+     * Deletes blocks explicitly deleted by the mutators while they were being marked.
+     * @param blocks unregistered blocks; the list is emptied.
+     */
+    void deleteBlocks(GCList<GCBlockHeader>& blocks);
+
+    /**
+     * Queues the given blocks for lazy or background sweeping.
+     * @param blocks unreachable blocks; the list is emptied.
+     */
+    void add(GCList<GCBlockHeader>&& blocks);
+
+    /**
+     * Sweeps up to the given number of queued blocks.
+     * @param maxCount maximum number of blocks to sweep.
+     * @return number of blocks swept.
+     */
+    size_t sweepQueued(size_t maxCount);
+
+    /**
+     * Sweeps all queued blocks.
+     */
+    void sweepQueued();
+
+    /**
+     * Waits for the blocks taken from the queue by other threads to be swept.
+     * It must not be invoked from a finalizer.
+     */
+    void wait();
+
+    /**
+     * Checks if lazy sweeping is enabled.
+     * @return true if unreachable blocks are queued in order to be swept by allocating threads.
+     */
+    bool isLazy() const noexcept;
+
+    /**
+     * Enables/disables lazy sweeping.
+     * @param lazy if true, unreachable blocks are queued in order to be swept by allocating threads.
+     */
+    void setLazy(bool lazy) noexcept;
+
+    /**
+     * Checks if background sweeping is enabled.
+     * @return true if unreachable blocks are queued in order to be swept by the background thread.
+     */
+    bool isBackground() const noexcept;
+
+    /**
+     * Enables/disables background sweeping.
+     * The background thread is started the first time background sweeping is enabled.
+     * @param background if true, unreachable blocks are queued in order to be swept by the background thread.
+     */
+    void setBackground(bool background);
+
+    /**
+     * Returns the number of threads that sweep blocks in parallel.
+     * @return the number of sweeper threads.
+     */
+    size_t getThreadCount();
+
+    /**
+     * Sets the number of threads that sweep blocks in parallel.
+     * @param count number of sweeper threads; if 0, it is set to 1.
+     */
+    void setThreadCount(size_t count);
+
+private:
+    //mutex for the queue and the background thread
+    std::mutex m_mutex;
+
+    //queued blocks
+    GCList<GCBlockHeader> m_blocks;
+
+    //true if there are queued blocks; allows allocating threads to check for work without locking
+    std::atomic<bool> m_pending{ false };
+
+    //number of sweeps in progress of blocks taken from the queue
+    size_t m_activeCount{ 0 };
+
+    //signals queued blocks or stop to the background thread
+    std::condition_variable m_workCond;
+
+    //signals the completion of a sweep of queued blocks
+    std::condition_variable m_doneCond;
+
+    //lazy sweeping flag
+    std::atomic<bool> m_lazy{ false };
+
+    //background sweeping flag
+    std::atomic<bool> m_background{ false };
+
+    //stop flag for the background thread
+    bool m_stop{ false };
+
+    //the background thread; started on demand
+    std::thread m_thread;
+
+    //mutex for the sweeper threads, which can only execute one sweep at a time
+    std::mutex m_workersMutex;
+
+    //sweeper threads
+    GCWorkerThreads m_workers;
+
+    //takes blocks from the queue
+    GCList<GCBlockHeader> take(size_t maxCount);
+
+    //marks the end of a sweep of queued blocks
+    void done();
+
+    //the background thread loop
+    void run();
+
+    //maximum number of slots freed at once
+    static constexpr size_t FreeBatchSize = 64;
+
+    //sweeps blocks in the current thread
+    static void sweepBlocks(GCList<GCBlockHeader>& blocks);
+
+    //sweeps a block
+    static void sweep(GCBlockHeader* block);
+};
+
+
+#endif //GCLIB_GCSWEEPER_HPP
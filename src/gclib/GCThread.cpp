@@ -1,6 +1,19 @@
 #include "GCCollectorData.hpp"
 
 
+//data of the current thread
+static thread_local GCThreadData* currentThreadData = nullptr;
+
+
+//waits until the collector resumes the threads
+static void waitForResume(GCCollectorData& collectorData) {
+    std::unique_lock lock(collectorData.stopMutex);
+    collectorData.stopCond.wait(lock, [&]() {
+        return !collectorData.stopRequested.load(std::memory_order_acquire);
+    });
+}
+
+
 ///Returns the one and only thread instance for this thread.
 GCThread& GCThread::instance() {
     static thread_local GCThread thread;
@@ -8,11 +21,60 @@ GCThread& GCThread::instance() {
 }
 
 
+//returns the data of the current thread
+GCThreadData* GCThread::currentData() noexcept {
+    return currentThreadData;
+}
+
+
+//enters a region in which the collector must not run
+void GCThread::enterRegion() {
+    std::atomic<size_t>& regionDepth = data->regionDepth;
+
+    //nested region; the collector is already excluded
+    const size_t depth = regionDepth.load(std::memory_order_relaxed);
+    if (depth > 0) {
+        regionDepth.store(depth + 1, std::memory_order_relaxed);
+        return;
+    }
+
+    GCCollectorData& collectorData = GCCollectorData::instance();
+
+    //announce the region, then check for a stop request; the collector does the opposite, 
+    //and therefore either the collector waits for the region to end or the thread waits for the collector
+    for (;;) {
+        regionDepth.store(1, std::memory_order_seq_cst);
+        if (!collectorData.stopRequested.load(std::memory_order_seq_cst)) {
+            return;
+        }
+        regionDepth.store(0, std::memory_order_seq_cst);
+        waitForResume(collectorData);
+    }
+}
+
+
+//leaves a region
+void GCThread::leaveRegion() noexcept {
+    data->regionDepth.store(data->regionDepth.load(std::memory_order_relaxed) - 1, std::memory_order_release);
+}
+
+
+//waits for the collector, if it has requested the threads to stop
+void GCThread::safepoint() {
+    GCCollectorData& collectorData = GCCollectorData::instance();
+    if (data->regionDepth.load(std::memory_order_relaxed) == 0 && collectorData.stopRequested.load(std::memory_order_acquire)) {
+        waitForResume(collectorData);
+    }
+}
+
+
 ///registers the thread to the collector.
 GCThread::GCThread() {
     GCCollectorData& collectorData = GCCollectorData::instance();
     std::lock_guard lock(collectorData.mutex);
+    std::lock_guard threadsLock(collectorData.threadsMutex);
     collectorData.threads.append(data);
+    currentThreadData = data;
 }
 
 
@@ -20,9 +82,21 @@ GCThread::GCThread() {
 GCThread::~GCThread() {
     GCCollectorData& collectorData = GCCollectorData::instance();
     std::lock_guard lock(collectorData.mutex);
+    std::lock_guard threadsLock(collectorData.threadsMutex);
+    currentThreadData = nullptr;
     data->detach();
+
+    //the values recorded by the snapshot barrier are kept, since the data might be deleted between marking slices
+    collectorData.flushOverwrittenPtrs(*data);
     mutex.lock();
     const bool empty = data->empty();
     mutex.unlock();
-    empty ? delete data : collectorData.terminatedThreads.append(data);
+    if (empty) {
+        //keep the allocation counters of the data, since the blocks counted might belong to other threads
+        collectorData.liveSize += data->allocSize.load(std::memory_order_relaxed) - data->freeSize.load(std::memory_order_relaxed);
+        delete data;
+    }
+    else {
+        collectorData.terminatedThreads.append(data);
+    }
 }
@@ -3,44 +3,97 @@
 
 
 #include <vector>
+#include <memory>
 #include "gclib/GCPtrStruct.hpp"
 #include "gclib/GCList.hpp"
 #include "GCBlockHeader.hpp"
+#include "GCArena.hpp"
+#include "GCShadowStack.hpp"
 
 
 /**
  * Per-thread heap-allocated data.
  */
 struct GCThreadData : GCNode<GCThreadData> {
-    ///the mutex of this thread
-    std::recursive_mutex mutex;
+    ///capacity of the buffer of overwritten values.
+    static constexpr size_t OverwrittenPtrCapacity = 256;
+
+    ///the mutex of the pointer lists of this thread; it protects their structure only, since pointers
+    ///of a thread might be destroyed by other threads.
+    std::mutex mutex;
+
+    ///number of nested regions of this thread in which the collector must not run;
+    ///if 0, the thread is at a safepoint. It is written only by this thread.
+    std::atomic<size_t> regionDepth{ 0 };
 
     ///the root pointers of this thread.
     GCList<GCPtrStruct> ptrs;
 
-    ///blocks allocated by this thread.
+    ///the root pointers of this thread that have automatic storage.
+    GCShadowStack shadowStack;
+
+    ///blocks allocated by this thread; in generational mode, the young blocks.
     GCList<GCBlockHeader> blocks;
 
-    ///marked blocks of this this thread.
-    GCList<GCBlockHeader> markedBlocks;
+    ///old blocks of this thread that are scanned at young collections only if they overlap dirty cards.
+    GCList<GCBlockHeader> oldBlocks;
+
+    ///old blocks of this thread that have gc pointers not covered by cards, i.e. blocks not allocated from arena pages,
+    ///blocks with a scan function and blocks with member pointers outside of their memory;
+    ///they are scanned at every young collection.
+    GCList<GCBlockHeader> oldScannedBlocks;
+
+    ///bytes allocated by this thread since the last collection;
+    ///it is written only by this thread, within a region, or by the collector.
+    std::atomic<size_t> allocSize{ 0 };
+
+    ///bytes freed by this thread since the last collection; it is written as the allocation size.
+    std::atomic<size_t> freeSize{ 0 };
+
+    ///bytes allocated by this thread that have not been added to the collector's allocation size yet;
+    ///it is accessed only within regions of this thread, or by the collector.
+    size_t unsharedAllocSize{ 0 };
+
+    ///values overwritten by this thread while blocks are marked along with the mutators (snapshot barrier);
+    ///it is written only within regions of this thread, and it is moved to the collector's queue when it is full,
+    ///or by the collector while the threads are stopped.
+    void* overwrittenPtrs[OverwrittenPtrCapacity];
+
+    ///number of values in the buffer of overwritten values.
+    size_t overwrittenPtrCount{ 0 };
+
+    ///memory arena of this thread; it provides the memory of blocks that do not have a custom allocator.
+    ///It is allocated separately, since its size classes are aligned to cache lines,
+    ///and the sentinel of a list of thread data, which is accessed as thread data, is not.
+    const std::unique_ptr<GCArena> arena{ std::make_unique<GCArena>() };
+
+    ///memory arena of this thread for blocks without gc pointers; keeping them apart
+    ///keeps the pages of the blocks that are scanned dense.
+    const std::unique_ptr<GCArena> leafArena{ std::make_unique<GCArena>() };
 
     ///checks if the data are empty.
     bool empty() const noexcept {
-        return ptrs.empty() && blocks.empty();
+        return ptrs.empty() && shadowStack.empty() && blocks.empty() && oldBlocks.empty() && oldScannedBlocks.empty() && arena->empty() && leafArena->empty();
     }
 };
 
 
+static_assert(alignof(GCThreadData) <= alignof(GCList<GCThreadData>), "thread data must not be over-aligned");
+
+
 /**
  * Per-thread thread-local data.
  */
 class GCThread {
 public:
+    ///number of bytes a thread can allocate before it adds them to the collector's allocation size.
+    static constexpr size_t AllocBudget = 64 * 1024;
+
     ///thread data; might outlive the thread, and therefore allocated on the heap
     GCThreadData* data = new GCThreadData;
 
     ///mutex shortcut
-    std::recursive_mutex& mutex{ data->mutex };
+    std::mutex& mutex{ data->mutex };
 
     ///current pointer list; overriden with a block's list when a block is allocated.
     GCList<GCPtrStruct>* ptrs{ &data->ptrs };
@@ -48,9 +101,24 @@ public:
     ///block list shortcut
     GCList<GCBlockHeader>& blocks{ data->blocks };
 
+    ///shadow stack shortcut
+    GCShadowStack& shadowStack{ data->shadowStack };
+
     ///Returns the one and only thread instance for this thread.
     static GCThread& instance();
 
+    ///returns the data of the current thread, or null if the current thread is not registered to the collector.
+    static GCThreadData* currentData() noexcept;
+
+    ///enters a region in which the collector must not run; if the collector is running, it waits for the collector to finish.
+    void enterRegion();
+
+    ///leaves a region entered with enterRegion.
+    void leaveRegion() noexcept;
+
+    ///if the collector has requested the threads to stop and the thread is not in a region, it waits for the collector to finish.
+    void safepoint();
+
     ///registers the thread to the collector.
     GCThread();
 
@@ -2,13 +2,13 @@
 #include "GCThread.hpp"
 
 
-//locks the current thread
+//enters a region of the current thread in which the collector does not run
 GCThreadLock::GCThreadLock() {
-    GCThread::instance().mutex.lock();
+    GCThread::instance().enterRegion();
 }
 
 
-//unlocks the current thread
+//leaves the region
 GCThreadLock::~GCThreadLock() {
-    GCThread::instance().mutex.unlock();
+    GCThread::instance().leaveRegion();
 }
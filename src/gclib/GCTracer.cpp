@@ -0,0 +1,14 @@
+#include "gclib/GCTracer.hpp"
+#include "GCMarker.hpp"
+
+
+//marks the block a pointer points to
+void GCTracer::visit(const void* value) noexcept {
+    m_marker.scan(const_cast<void*>(value));
+}
+
+
+//marks the blocks an array of pointers point to
+void GCTracer::visit(const void* const* values, size_t count) noexcept {
+    m_marker.scan(values, count);
+}
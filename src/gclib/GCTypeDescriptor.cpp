@@ -0,0 +1,8 @@
+#include "gclib/GCTypeDescriptor.hpp"
+#include "GCVTableRegistry.hpp"
+
+
+//registers a type descriptor
+uint16_t GCTypeIdPrivate::insert(const GCTypeDescriptor& descriptor) {
+    return GCVTableRegistry::insert(descriptor);
+}
@@ -0,0 +1,52 @@
+#include <stdexcept>
+#include "GCVTableRegistry.hpp"
+
+
+//the descriptors
+std::atomic<const GCTypeDescriptor*> GCVTableRegistry::m_descriptors[GCVTableRegistry::Capacity];
+
+
+//next free index per free index
+uint16_t GCVTableRegistry::m_nextFreeIndexes[GCVTableRegistry::Capacity];
+
+
+//first index of the free list
+uint16_t GCVTableRegistry::m_freeIndex{ 0 };
+
+
+//number of indexes used so far
+size_t GCVTableRegistry::m_count{ 1 };
+
+
+//mutex for registrations
+std::mutex GCVTableRegistry::m_mutex;
+
+
+//registers a type descriptor
+uint16_t GCVTableRegistry::insert(const GCTypeDescriptor& descriptor) {
+    std::lock_guard lock(m_mutex);
+
+    //reuse the index of an unregistered descriptor, otherwise use a new index
+    uint16_t index = m_freeIndex;
+    if (index) {
+        m_freeIndex = m_nextFreeIndexes[index];
+    }
+    else if (m_count < Capacity) {
+        index = static_cast<uint16_t>(m_count++);
+    }
+    else {
+        throw std::runtime_error("type descriptor registry is full: 65535 descriptors are registered");
+    }
+
+    m_descriptors[index].store(&descriptor, std::memory_order_release);
+    return index;
+}
+
+
+//unregisters a type descriptor
+void GCVTableRegistry::remove(uint16_t index) noexcept {
+    std::lock_guard lock(m_mutex);
+    m_descriptors[index].store(nullptr, std::memory_order_release);
+    m_nextFreeIndexes[index] = m_freeIndex;
+    m_freeIndex = index;
+}
@@ -0,0 +1,78 @@
+#ifndef GCLIB_GCVTABLEREGISTRY_HPP
+#define GCLIB_GCVTABLEREGISTRY_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <atomic>
+#include <mutex>
+#include "gclib/GCTypeDescriptor.hpp"
+
+
+/**
+ * Table of type descriptors, indexed by type id.
+ *
+ * The descriptors are those of the types allocated by gcnew and those of the block header vtables.
+ * The indexes of unregistered descriptors are kept in a free list and reused by later registrations;
+ * a descriptor must not be unregistered while blocks refer to it.
+ * Index 0 is not used, so as that a zero type id means a type id that has not been initialized yet.
+ * The table is statically initialized, so as that descriptors can be registered/unregistered
+ * during static initialization/destruction.
+ * Registrations are serialized by a mutex; lookups read the table without locking,
+ * and see the descriptor a type id was registered with, since the table entries are published with release order.
+ */
+class GCVTableRegistry {
+public:
+    ///maximum number of descriptors.
+    static constexpr size_t Capacity = size_t(1) << 16;
+
+    /**
+     * Registers a type descriptor.
+     * @param descriptor descriptor to register.
+     * @return the type id of the descriptor.
+     * @exception std::runtime_error thrown if all the indexes are used by registered descriptors.
+     */
+    static uint16_t insert(const GCTypeDescriptor& descriptor);
+
+    /**
+     * Unregisters a type descriptor.
+     * Its index might be reused by the next registration; therefore the descriptor must be unregistered
+     * only after the blocks that refer to it have been swept or deleted.
+     * @param index type id of the descriptor.
+     */
+    static void remove(uint16_t index) noexcept;
+
+    /**
+     * Returns a type descriptor.
+     * @param index type id of the descriptor; it must be registered.
+     * @return the descriptor.
+     */
+    static const GCTypeDescriptor& get(uint16_t index) noexcept {
+        const GCTypeDescriptor* descriptor = m_descriptors[index].load(std::memory_order_acquire);
+
+        //a null descriptor means that a block outlived the vtable it was allocated with
+        assert(descriptor);
+
+        return *descriptor;
+    }
+
+private:
+    //the descriptors
+    static std::atomic<const GCTypeDescriptor*> m_descriptors[Capacity];
+
+    //next free index per free index; 0 terminates the free list
+    static uint16_t m_nextFreeIndexes[Capacity];
+
+    //first index of the free list; 0 if the list is empty
+    static uint16_t m_freeIndex;
+
+    //number of indexes used so far, including the unused index 0; indexes below it are either registered or in the free list
+    static size_t m_count;
+
+    //mutex for registrations
+    static std::mutex m_mutex;
+};
+
+
+#endif //GCLIB_GCVTABLEREGISTRY_HPP
@@ -0,0 +1,48 @@
+#include "gclib/GCWeakPtr.hpp"
+#include "GCCollectorData.hpp"
+
+
+//init ptr, register it to the collector
+void GCWeakPtrPrivate::init(GCWeakPtrStruct* ptr, void* value) {
+    GCCollectorData& collectorData = GCCollectorData::instance();
+    ptr->value.store(value, std::memory_order_relaxed);
+    std::lock_guard lock(collectorData.weakPtrsMutex);
+    collectorData.weakPtrs.append(ptr);
+}
+
+
+//init ptr, copy the value of another weak ptr
+void GCWeakPtrPrivate::initCopy(GCWeakPtrStruct* ptr, const GCWeakPtrStruct* src) {
+    //the collector must not clear the source between reading its value and registering the new ptr
+    GCThreadLock region;
+    init(ptr, src->value.load(std::memory_order_acquire));
+}
+
+
+//copy the value of another weak ptr
+void GCWeakPtrPrivate::copy(GCWeakPtrStruct* ptr, const GCWeakPtrStruct* src) {
+    //the collector must not clear the source between reading its value and storing it
+    GCThreadLock region;
+    ptr->value.store(src->value.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+
+//returns the value, made reachable for the collection in progress
+void* GCWeakPtrPrivate::lock(const GCWeakPtrStruct* ptr) {
+    //while marking along with the mutators, the block might not be marked yet, 
+    //and therefore its value is recorded like an overwritten value, so as that it is marked
+    GCCollectorData& collectorData = GCCollectorData::instance();
+    void* value = ptr->value.load(std::memory_order_acquire);
+    if (collectorData.snapshotMarking.load(std::memory_order_relaxed)) {
+        collectorData.recordOverwrittenPtr(*GCThread::instance().data, value);
+    }
+    return value;
+}
+
+
+//remove ptr from collector
+void GCWeakPtrPrivate::cleanup(GCWeakPtrStruct* ptr) {
+    GCCollectorData& collectorData = GCCollectorData::instance();
+    std::lock_guard lock(collectorData.weakPtrsMutex);
+    ptr->detach();
+}
@@ -0,0 +1,97 @@
+#include "GCWorkerThreads.hpp"
+
+
+//the default constructor
+GCWorkerThreads::GCWorkerThreads() noexcept {
+}
+
+
+//stops the worker threads
+GCWorkerThreads::~GCWorkerThreads() {
+    stop();
+}
+
+
+//returns the number of threads
+size_t GCWorkerThreads::getCount() const noexcept {
+    return m_threads.size() + 1;
+}
+
+
+//sets the number of threads
+void GCWorkerThreads::setCount(size_t count) {
+    count = count ? count - 1 : 0;
+
+    //threads are indexed, and therefore they are all restarted when the count changes
+    if (count != m_threads.size()) {
+        stop();
+        for (size_t index = 1; index <= count; ++index) {
+            m_threads.emplace_back([this, index, generation = m_generation]() { threadProc(index, generation); });
+        }
+    }
+}
+
+
+//executes the given function in all threads
+void GCWorkerThreads::run(const std::function<void(size_t)>& func) {
+
+    //start the work in the worker threads
+    if (!m_threads.empty()) {
+        std::lock_guard lock(m_mutex);
+        m_func = &func;
+        m_pending = m_threads.size();
+        ++m_generation;
+        m_workCond.notify_all();
+    }
+
+    //do the work in this thread
+    func(0);
+
+    //wait for the worker threads to finish
+    if (!m_threads.empty()) {
+        std::unique_lock lock(m_mutex);
+        m_doneCond.wait(lock, [this]() { return m_pending == 0; });
+        m_func = nullptr;
+    }
+}
+
+
+//stops all worker threads
+void GCWorkerThreads::stop() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopCount = m_threads.size();
+        m_workCond.notify_all();
+    }
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+    m_threads.clear();
+}
+
+
+//the thread loop
+void GCWorkerThreads::threadProc(size_t index, size_t generation) {
+    std::unique_lock lock(m_mutex);
+    for (;;) {
+        m_workCond.wait(lock, [&]() { return m_stopCount > 0 || m_generation != generation; });
+
+        //exit if stopped
+        if (m_stopCount > 0) {
+            --m_stopCount;
+            return;
+        }
+
+        //execute the work
+        generation = m_generation;
+        const std::function<void(size_t)>& func = *m_func;
+        lock.unlock();
+        func(index);
+        lock.lock();
+
+        //notify the requesting thread when all threads are done
+        if (--m_pending == 0) {
+            m_doneCond.notify_one();
+        }
+    }
+}
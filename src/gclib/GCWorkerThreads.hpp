@@ -0,0 +1,80 @@
+#ifndef GCLIB_GCWORKERTHREADS_HPP
+#define GCLIB_GCWORKERTHREADS_HPP
+
+
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+
+/**
+ * Pool of threads that execute collection work in parallel with the thread that requests the work.
+ */
+class GCWorkerThreads {
+public:
+    ///the default constructor; there are no worker threads initially.
+    GCWorkerThreads() noexcept;
+
+    ///stops the worker threads.
+    ~GCWorkerThreads();
+
+    GCWorkerThreads(const GCWorkerThreads&) = delete;
+    GCWorkerThreads& operator = (const GCWorkerThreads&) = delete;
+
+    /**
+     * Returns the number of threads that execute the work, including the thread that requests it.
+     * @return the number of threads.
+     */
+    size_t getCount() const noexcept;
+
+    /**
+     * Sets the number of threads that execute the work, including the thread that requests it.
+     * It must not be invoked while work is being executed.
+     * @param count number of threads; if 0, then it is set to 1.
+     */
+    void setCount(size_t count);
+
+    /**
+     * Executes the given function in all threads and waits for all of them to finish.
+     * The calling thread executes the function with index 0, worker threads with indexes 1 to count - 1.
+     * @param func function to execute; it receives the index of the executing thread.
+     */
+    void run(const std::function<void(size_t)>& func);
+
+private:
+    //worker threads
+    std::vector<std::thread> m_threads;
+
+    //mutex for the members below
+    std::mutex m_mutex;
+
+    //condition variable that signals new work or stop
+    std::condition_variable m_workCond;
+
+    //condition variable that signals the completion of work
+    std::condition_variable m_doneCond;
+
+    //current work
+    const std::function<void(size_t)>* m_func{ nullptr };
+
+    //incremented for each work, so as that each thread executes the work once
+    size_t m_generation{ 0 };
+
+    //number of worker threads that have not finished the current work
+    size_t m_pending{ 0 };
+
+    //number of worker threads that shall exit
+    size_t m_stopCount{ 0 };
+
+    //stops all worker threads
+    void stop();
+
+    //the thread loop; the generation is the one of the last work that the thread shall not execute
+    void threadProc(size_t index, size_t generation);
+};
+
+
+#endif //GCLIB_GCWORKERTHREADS_HPP
@@ -4,8 +4,12 @@
 #include <string>
 #include <vector>
 #include <mutex>
+#include <thread>
 #include <condition_variable>
 #include <deque>
+#include <random>
+#include <optional>
+#include <stdexcept>
 #include "gclib.hpp"
 
 
@@ -522,9 +526,9 @@ struct Node1 : GCIScannableObject {
         count.fetch_sub(1, std::memory_order_relaxed);
     }
 
-    void scan() const noexcept final {
-        left.scan();
-        right.scan();
+    void scan(GCTracer& tracer) const noexcept final {
+        left.scan(tracer);
+        right.scan(tracer);
     }
 };
 
@@ -675,6 +679,1528 @@ void test19() {
 }
 
 
+void test20() {
+    doTest("pointer to middle of large array", []() {
+        size_t prevAllocSize = GC::getAllocSize();
+        int prevCount = count;
+
+        //initialize; the array spans several pages
+        GCPtr<Node> nodeArray = gcnewArray<Node>(4096, 1);
+        nodeArray += 4000;
+
+        //try to collect
+        size_t allocSize = GC::collect();
+
+        //check
+        check(allocSize > prevAllocSize, "Data should not have been collected");
+        check(count == prevCount + 4096, "Array objects should not have been destroyed");
+
+        //collect
+        nodeArray = nullptr;
+        allocSize = GC::collect();
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount, "Array objects not destroyed correctly");
+    });
+}
+
+
+struct ListNode {
+    GCPtr<ListNode> next;
+
+    ListNode() {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~ListNode() {
+        count.fetch_sub(1, std::memory_order_relaxed);
+    }
+};
+
+
+void test21() {
+    doTest("deep linked list, 2^19 nodes", []() {
+        size_t prevAllocSize = GC::getAllocSize();
+        int prevCount = count;
+
+        //initialize; marking the list must not recurse per node
+        const int NodeCount = 1 << 19;
+        GCPtr<ListNode> head;
+        for (int i = 0; i < NodeCount; ++i) {
+            GCPtr<ListNode> node = gcnew<ListNode>();
+            node->next = head;
+            head = node;
+        }
+
+        //try to collect
+        size_t allocSize = GC::collect();
+
+        //check
+        check(allocSize > prevAllocSize, "Data should not have been collected");
+        check(count == prevCount + NodeCount, "List nodes should not have been destroyed");
+
+        //collect
+        head = nullptr;
+        allocSize = GC::collect();
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount, "List nodes not destroyed correctly");
+    });
+}
+
+
+struct TreeNode {
+    GCPtr<TreeNode> left;
+    GCPtr<TreeNode> right;
+
+    TreeNode() {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~TreeNode() {
+        count.fetch_sub(1, std::memory_order_relaxed);
+    }
+};
+
+
+static GCPtr<TreeNode> createTree(int depth) {
+    GCPtr<TreeNode> node = gcnew<TreeNode>();
+    if (depth > 1) {
+        node->left = createTree(depth - 1);
+        node->right = createTree(depth - 1);
+    }
+    return node;
+}
+
+
+void test22() {
+    doTest("parallel marking, 4 marker threads", []() {
+        GC::setMarkerThreadCount(4);
+        check(GC::getMarkerThreadCount() == 4, "Marker thread count not set");
+
+        size_t prevAllocSize = GC::getAllocSize();
+        int prevCount = count;
+
+        //initialize; a tree has enough breadth for the markers to share the work
+        const int NodeCount = (1 << 17) - 1;
+        GCPtr<TreeNode> root = createTree(17);
+
+        //try to collect
+        size_t allocSize = GC::collect();
+
+        //check
+        check(allocSize > prevAllocSize, "Data should not have been collected");
+        check(count == prevCount + NodeCount, "Tree nodes should not have been destroyed");
+
+        //collect
+        root = nullptr;
+        allocSize = GC::collect();
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount, "Tree nodes not destroyed correctly");
+
+        GC::setMarkerThreadCount(1);
+    });
+}
+
+
+void test23() {
+    doTest("compact block header", []() {
+        size_t prevAllocSize = GC::getAllocSize();
+        int prevCount = count;
+
+        //check
+        check(GC::getBlockHeaderSize() == 4 * sizeof(void*) + 8, "Block header is not compact");
+
+        //initialize
+        GCPtr<ListNode> node = gcnew<ListNode>();
+
+        //check
+        check(GC::getAllocSize() == prevAllocSize + sizeof(ListNode) + GC::getBlockHeaderSize(), "Invalid allocation size");
+
+        //collect
+        node = nullptr;
+        size_t allocSize = GC::collect();
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount, "Data not destroyed correctly");
+    });
+}
+
+
+void test24() {
+    doTest("per-thread allocation accounting", []() {
+        size_t prevAllocSize = GC::getAllocSize();
+        int prevCount = count;
+        const size_t prevAllocLimit = GC::getAllocLimit();
+
+        //check
+        GC::setAllocLimit(prevAllocLimit * 2);
+        check(GC::getAllocLimit() == prevAllocLimit * 2, "Allocation limit not set");
+        GC::setAllocLimit(prevAllocLimit);
+
+        //initialize; each thread allocates into its own counters
+        const int ThreadCount = 4;
+        const int NodeCount = 1000;
+        GCPtr<ListNode> heads[ThreadCount];
+        std::thread threads[ThreadCount];
+        for (int i = 0; i < ThreadCount; ++i) {
+            threads[i] = std::thread([&head = heads[i]]() {
+                for (int j = 0; j < NodeCount; ++j) {
+                    GCPtr<ListNode> node = gcnew<ListNode>();
+                    node->next = head;
+                    head = node;
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        //check
+        check(GC::getAllocSize() == prevAllocSize + ThreadCount * NodeCount * (sizeof(ListNode) + GC::getBlockHeaderSize()), "Invalid allocation size");
+
+        //delete one list explicitly; the counters of this thread must account for the blocks of the other thread
+        while (heads[0]) {
+            GCPtr<ListNode> next = heads[0]->next;
+            gcdelete(std::move(heads[0]));
+            heads[0] = next;
+        }
+
+        //check
+        check(GC::getAllocSize() == prevAllocSize + (ThreadCount - 1) * NodeCount * (sizeof(ListNode) + GC::getBlockHeaderSize()), "Invalid allocation size");
+
+        //collect
+        for (GCPtr<ListNode>& head : heads) {
+            head = nullptr;
+        }
+        size_t allocSize = GC::collect();
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount, "Data not destroyed correctly");
+    });
+}
+
+
+static GCLocalPtr<ListNode> createLocalList(int depth) {
+    GCLocalPtr<ListNode> node = gcnew<ListNode>();
+    if (depth > 1) {
+        //the nested call pushes slots over several chunks of the shadow stack
+        GCLocalPtr<ListNode> next = createLocalList(depth - 1);
+        node->next = next;
+    }
+    //two named candidates prevent the return value optimization, so as that slots are released out of order
+    GCLocalPtr<ListNode> other = node;
+    if (depth % 2) {
+        return node;
+    }
+    return other;
+}
+
+
+void test25() {
+    doTest("local ptrs", []() {
+        size_t prevAllocSize = GC::getAllocSize();
+        int prevCount = count;
+
+        //initialize
+        const int NodeCount = 3000;
+        {
+            GCLocalPtr<ListNode> head = createLocalList(NodeCount);
+
+            //try to collect
+            size_t allocSize = GC::collect();
+
+            //check
+            check(allocSize > prevAllocSize, "Data should not have been collected");
+            check(count == prevCount + NodeCount, "List nodes should not have been destroyed");
+        }
+
+        //collect
+        size_t allocSize = GC::collect();
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount, "List nodes not destroyed correctly");
+    });
+}
+
+
+void test26() {
+    doTest("safepoints, pointer stores during collection", []() {
+        size_t prevAllocSize = GC::getAllocSize();
+        int prevCount = count;
+
+        //threads that keep walking and relinking their lists while the main thread collects
+        const int ThreadCount = 4;
+        const int NodeCount = 1000;
+        std::atomic<bool> done{ false };
+        std::atomic<int> readyCount{ 0 };
+        std::atomic<int> errors{ 0 };
+        std::vector<std::thread> threads;
+        for (int threadIndex = 0; threadIndex < ThreadCount; ++threadIndex) {
+            threads.emplace_back([&]() {
+                GCPtr<ListNode> head;
+                for (int index = 0; index < NodeCount; ++index) {
+                    GCPtr<ListNode> node = gcnew<ListNode>();
+                    node->next = head;
+                    head = node;
+                }
+                ++readyCount;
+                while (!done.load()) {
+                    //rotate the list: move the head to the end
+                    GCPtr<ListNode> first = head;
+                    head = first->next;
+                    first->next = nullptr;
+                    GCPtr<ListNode> last = head;
+                    int length = 2;
+                    while (last->next) {
+                        last = last->next;
+                        ++length;
+                    }
+                    last->next = first;
+                    if (length != NodeCount) {
+                        ++errors;
+                    }
+                    GC::safepoint();
+                }
+            });
+        }
+        while (readyCount.load() < ThreadCount) {
+            std::this_thread::yield();
+        }
+
+        //collect while the threads are running
+        for (int index = 0; index < 20; ++index) {
+            GC::collect();
+            check(count == prevCount + ThreadCount * NodeCount, "List nodes should not have been destroyed");
+        }
+        done = true;
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        check(errors.load() == 0, "Invalid list length");
+
+        //collect
+        size_t allocSize = GC::collect();
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount, "List nodes not destroyed correctly");
+    });
+}
+
+
+void test27() {
+    doTest("lazy sweeping", []() {
+        size_t prevAllocSize = GC::getAllocSize();
+        int prevCount = count;
+        GC::setLazySweep(true);
+
+        //create garbage
+        const int NodeCount = 1000;
+        {
+            GCPtr<ListNode> head;
+            for (int index = 0; index < NodeCount; ++index) {
+                GCPtr<ListNode> node = gcnew<ListNode>();
+                node->next = head;
+                head = node;
+            }
+        }
+
+        //collect; the garbage must not be finalized by the collection
+        size_t allocSize = GC::collect();
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount + NodeCount, "List nodes should not have been destroyed yet");
+
+        //allocations sweep some of the garbage
+        {
+            GCPtr<ListNode> node = gcnew<ListNode>();
+            check(count < prevCount + NodeCount + 1, "Allocation should have swept blocks");
+            check(count > prevCount + 1, "Allocation should have swept only a few blocks");
+        }
+
+        //sweep the rest
+        GC::sweep();
+        check(count == prevCount + 1, "List nodes not destroyed correctly");
+
+        //collect the last node
+        GC::setLazySweep(false);
+        allocSize = GC::collect();
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount, "List nodes not destroyed correctly");
+    });
+}
+
+
+void test28() {
+    doTest("parallel background sweeping, 4 sweeper threads", []() {
+        size_t prevAllocSize = GC::getAllocSize();
+        int prevCount = count;
+        GC::setSweeperThreadCount(4);
+        GC::setBackgroundSweep(true);
+
+        //create garbage
+        const int NodeCount = 100000;
+        {
+            GCPtr<ListNode> head;
+            for (int index = 0; index < NodeCount; ++index) {
+                GCPtr<ListNode> node = gcnew<ListNode>();
+                node->next = head;
+                head = node;
+            }
+        }
+
+        //collect; the garbage is swept by the background thread
+        size_t allocSize = GC::collect();
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        waitCollection(prevCount);
+        check(count == prevCount, "List nodes not destroyed correctly");
+
+        //collect again, with sweeping in the collecting thread
+        GC::setBackgroundSweep(false);
+        {
+            GCPtr<ListNode> head;
+            for (int index = 0; index < NodeCount; ++index) {
+                GCPtr<ListNode> node = gcnew<ListNode>();
+                node->next = head;
+                head = node;
+            }
+        }
+        allocSize = GC::collect();
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount, "List nodes not destroyed correctly");
+        GC::setSweeperThreadCount(1);
+    });
+}
+
+
+struct Point {
+    double x;
+    double y;
+};
+
+
+void test29() {
+    doTest("trivial blocks, bulk free", []() {
+        //check the traits
+        check(GCBlockHeaderVTable<Point>::Traits == GCIBlockHeaderVTable::Trivial, "Point should be trivial");
+        check(GCBlockHeaderVTable<double[]>::Traits == GCIBlockHeaderVTable::Trivial, "double[] should be trivial");
+        check(!(GCBlockHeaderVTable<ListNode>::Traits & GCIBlockHeaderVTable::TriviallyDestructible), "ListNode should not be trivially destructible");
+        check(!(GCBlockHeaderVTable<ListNode>::Traits & GCIBlockHeaderVTable::NoPtrs), "ListNode should have ptrs");
+
+        size_t prevAllocSize = GC::getAllocSize();
+
+        //create garbage
+        const int PointCount = 100000;
+        {
+            std::vector<GCPtr<Point>> points;
+            for (int index = 0; index < PointCount; ++index) {
+                points.push_back(gcnew<Point>(Point{ double(index), double(index) }));
+            }
+            GCPtr<double> small = gcnewArray<double>(16);
+            GCPtr<double> large = gcnewArray<double>(100000);
+
+            //try to collect
+            size_t allocSize = GC::collect();
+
+            //check
+            check(allocSize > prevAllocSize, "Data should not have been collected");
+            check(points.back()->x == PointCount - 1, "Data corrupted");
+        }
+
+        //collect
+        size_t allocSize = GC::collect();
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+
+        //the freed slots must be reusable
+        {
+            std::vector<GCPtr<Point>> points;
+            for (int index = 0; index < PointCount; ++index) {
+                points.push_back(gcnew<Point>(Point{ double(index), double(index) }));
+            }
+            for (int index = 0; index < PointCount; ++index) {
+                if (points[index]->x != index) {
+                    check(false, "Data corrupted");
+                    break;
+                }
+            }
+        }
+        allocSize = GC::collect();
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+    });
+}
+
+
+struct LeafRecord {
+    std::string text;
+
+    LeafRecord(const std::string& t) : text(t) {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~LeafRecord() {
+        count.fetch_sub(1, std::memory_order_relaxed);
+    }
+};
+
+
+void test30() {
+    doTest("leaf objects", []() {
+        size_t prevAllocSize = GC::getAllocSize();
+        int prevCount = count;
+
+        //check the traits
+        check(GCBlockHeaderVTable<char[]>::Traits & GCIBlockHeaderVTable::NoPtrs, "char[] should be a leaf type");
+        check(!(GCBlockHeaderVTable<LeafRecord>::Traits & GCIBlockHeaderVTable::NoPtrs), "LeafRecord should not be detected as a leaf type");
+
+        //initialize
+        const int RecordCount = 1000;
+        {
+            std::vector<GCPtr<LeafRecord>> records;
+            for (int index = 0; index < RecordCount; ++index) {
+                records.push_back(gcnewLeaf<LeafRecord>(std::to_string(index)));
+            }
+            GCPtr<LeafRecord> array = gcnewArrayLeaf<LeafRecord>(10, "array");
+            GCPtr<char> buffer = gcnewArray<char>(1000);
+
+            //try to collect
+            size_t allocSize = GC::collect();
+
+            //check
+            check(allocSize > prevAllocSize, "Data should not have been collected");
+            check(count == prevCount + RecordCount + 10, "Leaf objects should not have been destroyed");
+            check(records[RecordCount - 1]->text == std::to_string(RecordCount - 1), "Data corrupted");
+            check(array.get()[9].text == "array", "Data corrupted");
+        }
+
+        //collect
+        size_t allocSize = GC::collect();
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount, "Leaf objects not destroyed correctly");
+    });
+}
+
+
+void test31() {
+    doTest("large objects", []() {
+        size_t prevAllocSize = GC::getAllocSize();
+        size_t prevLargeObjectSize = GC::getLargeObjectSize();
+
+        //initialize
+        const size_t DoubleCount = 1024 * 1024;
+        {
+            GCPtr<double> buffer1 = gcnewArray<double>(DoubleCount);
+            GCPtr<double> buffer2 = gcnewArray<double>(DoubleCount, 1.0);
+
+            //check
+            check(GC::getLargeObjectSize() >= prevLargeObjectSize + 2 * DoubleCount * sizeof(double), "Large objects should have been mapped");
+            check(buffer1.get()[0] == 0 && buffer1.get()[DoubleCount - 1] == 0, "Large array should have been zero-filled");
+            check(buffer2.get()[0] == 1 && buffer2.get()[DoubleCount - 1] == 1, "Large array should have been initialized");
+
+            //a pointer to the middle must keep the buffer alive
+            GCPtr<double> middle = buffer1.get() + DoubleCount / 2;
+            buffer1 = nullptr;
+            GC::collect();
+            check(GC::getLargeObjectSize() >= prevLargeObjectSize + 2 * DoubleCount * sizeof(double), "Large objects should not have been unmapped");
+        }
+
+        //collect
+        size_t allocSize = GC::collect();
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(GC::getLargeObjectSize() == prevLargeObjectSize, "Large objects should have been unmapped");
+    });
+}
+
+
+void test32() {
+    doTest("returning free arena pages to the system", []() {
+        size_t prevAllocSize = GC::getAllocSize();
+        const size_t prevRetention = GC::getMemoryRetention();
+        GC::setMemoryRetention(0);
+
+        //create garbage
+        const int PointCount = 100000;
+        {
+            std::vector<GCPtr<Point>> points;
+            for (int index = 0; index < PointCount; ++index) {
+                points.push_back(gcnew<Point>(Point{ double(index), double(index) }));
+            }
+        }
+
+        //collect, then release the free pages
+        size_t allocSize = GC::collect();
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        size_t releasedSize = GC::releaseMemory();
+        check(releasedSize >= PointCount * sizeof(Point), "Free pages should have been released");
+
+        //the released pages must be reusable
+        {
+            std::vector<GCPtr<Point>> points;
+            for (int index = 0; index < PointCount; ++index) {
+                points.push_back(gcnew<Point>(Point{ double(index), double(index) }));
+            }
+            for (int index = 0; index < PointCount; ++index) {
+                if (points[index]->x != index) {
+                    check(false, "Data corrupted");
+                    break;
+                }
+            }
+        }
+
+        //with a large retention size, nothing is released
+        allocSize = GC::collect();
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        GC::setMemoryRetention(SIZE_MAX);
+        check(GC::releaseMemory() == 0, "Free pages should have been retained");
+        GC::setMemoryRetention(prevRetention);
+    });
+}
+
+
+void test33() {
+    doTest("arena pages backed by huge pages", []() {
+        const bool prevHugePages = GC::getHugePages();
+        GC::setHugePages(true);
+        check(GC::getHugePages(), "Huge pages not enabled");
+        size_t prevAllocSize = GC::getAllocSize();
+        int prevCount = count;
+
+        {
+            //the tree is allocated by a new thread, so as that it is allocated from new arena pages
+            const int NodeCount = (1 << 16) - 1;
+            GCPtr<TreeNode> root;
+            std::thread([&]() { root = createTree(16); }).join();
+            GC::collect();
+            check(count == prevCount + NodeCount, "Tree nodes should not have been destroyed");
+
+            //unreachable subtrees are collected
+            root->left = nullptr;
+            GC::collect();
+            check(count == prevCount + NodeCount / 2 + 1, "Unreachable tree nodes should have been destroyed");
+        }
+
+        //collect
+        size_t allocSize = GC::collect();
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount, "Nodes not destroyed correctly");
+        GC::setHugePages(prevHugePages);
+    });
+}
+
+
+void test34() {
+    //member pointers outside of the object
+    struct ListNodeVector {
+        std::vector<GCPtr<ListNode>> items;
+        ListNodeVector() : items(16) {}
+    };
+
+    doTest("generational collection", []() {
+        size_t prevAllocSize = GC::getAllocSize();
+        const size_t prevPromotionAge = GC::getPromotionAge();
+        const size_t prevThreshold = GC::getFullCollectionThreshold();
+        GC::setGenerational(true);
+        GC::setPromotionAge(2);
+        GC::setFullCollectionThreshold(SIZE_MAX / 2);
+        int prevCount = count;
+
+        {
+            //the first collection resets the generations; the node is promoted after two more collections
+            GCPtr<ListNode> old = gcnew<ListNode>();
+            GC::collect();
+            GC::collect();
+            GC::collect();
+            check(GC::getOldGenerationSize() >= sizeof(ListNode), "Node should have been promoted");
+
+            //the cards of the promoted node are cleaned by the next collection, since it points to no young node
+            GC::collect();
+
+            //a young node reachable only from the old node must survive young collections
+            old->next = gcnew<ListNode>();
+            GC::collect();
+            check(count == prevCount + 2, "Young node reachable from old node should not have been collected");
+            GC::collect();
+            check(count == prevCount + 2, "Young node reachable from old node should not have been collected");
+
+            //young garbage is collected by young collections
+            for (int index = 0; index < 100; ++index) {
+                gcnew<ListNode>();
+            }
+            GC::collect();
+            check(count == prevCount + 2, "Young garbage should have been collected");
+
+            //old garbage is collected only by full collections
+            old = nullptr;
+            GC::collect();
+            check(count == prevCount + 2, "Old garbage should not have been collected by a young collection");
+        }
+
+        {
+            //the member pointers of a promoted block that are outside of its memory are not covered by cards;
+            //a young node reachable only through them must survive young collections
+            const size_t prevOldSize = GC::getOldGenerationSize();
+            GCPtr<ListNodeVector> holder = gcnew<ListNodeVector>();
+            GC::collect();
+            GC::collect();
+            check(GC::getOldGenerationSize() >= prevOldSize + sizeof(ListNodeVector), "Holder should have been promoted");
+
+            //the cards of the promoted holder are cleaned by the next collection
+            GC::collect();
+            holder->items[3] = gcnew<ListNode>();
+            GC::collect();
+            check(count == prevCount + 3, "Young node reachable from outside of old block should not have been collected");
+            GC::collect();
+            check(count == prevCount + 3, "Young node reachable from outside of old block should not have been collected");
+            holder = nullptr;
+        }
+
+        //collect
+        size_t allocSize = GC::collectFull();
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount, "Old garbage should have been collected by a full collection");
+
+        GC::setGenerational(false);
+        GC::collect();
+        GC::setPromotionAge(prevPromotionAge);
+        GC::setFullCollectionThreshold(prevThreshold);
+    });
+}
+
+
+void test35() {
+    doTest("concurrent marking, node moved during collections", []() {
+        size_t prevAllocSize = GC::getAllocSize();
+        GC::setConcurrentMarking(true);
+        int prevCount = count;
+
+        {
+            //create a long list; its last node is reachable only through the list
+            const int NodeCount = 100000;
+            GCPtr<ListNode> head = gcnew<ListNode>();
+            ListNode* last = head.get();
+            for (int index = 1; index < NodeCount; ++index) {
+                last->next = gcnew<ListNode>();
+                last = last->next.get();
+            }
+            GCPtr<ListNode> spare = gcnew<ListNode>();
+
+            //another thread moves a node between the end of the list and a root, while collections mark the list;
+            //the node must survive even if it is moved to the root after the roots are scanned
+            std::atomic<bool> stop{ false };
+            std::thread mutator([&]() {
+                while (!stop.load(std::memory_order_relaxed)) {
+                    if (spare) {
+                        last->next = spare;
+                        spare = nullptr;
+                    }
+                    else {
+                        spare = last->next;
+                        last->next = nullptr;
+                    }
+                    gcnew<Point>();
+                }
+            });
+            for (int index = 0; index < 20; ++index) {
+                GC::collect();
+            }
+            stop = true;
+            mutator.join();
+
+            //check
+            GC::collect();
+            check(count == prevCount + NodeCount + 1, "Reachable nodes should not have been destroyed");
+        }
+
+        //collect
+        size_t allocSize = GC::collect();
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount, "Nodes not destroyed correctly");
+        GC::setConcurrentMarking(false);
+    });
+}
+
+
+void test36() {
+    doTest("blocks outside of arenas, allocated and freed during concurrent marking", []() {
+        size_t prevAllocSize = GC::getAllocSize();
+        GC::setConcurrentMarking(true);
+        GC::setMarkerThreadCount(4);
+
+        {
+            //arrays larger than the arena slots share pages; the ones kept must survive with their contents
+            const size_t KeptCount = 64;
+            std::vector<GCPtr<double>> kept;
+            for (size_t index = 0; index < KeptCount; ++index) {
+                kept.push_back(gcnewArray<double>(1100 + index * 37, static_cast<double>(index)));
+            }
+
+            //other threads replace arrays of varying size, so as that the page map is modified while the markers read it
+            std::atomic<bool> stop{ false };
+            std::vector<std::thread> mutators;
+            for (int threadIndex = 0; threadIndex < 2; ++threadIndex) {
+                mutators.emplace_back([&, threadIndex]() {
+                    std::mt19937 random(threadIndex);
+                    std::vector<GCPtr<double>> arrays(32);
+                    while (!stop.load(std::memory_order_relaxed)) {
+                        arrays[random() % arrays.size()] = gcnewArray<double>(1100 + random() % 30000);
+                    }
+                });
+            }
+            for (int index = 0; index < 20; ++index) {
+                GC::collect();
+            }
+            stop = true;
+            for (std::thread& mutator : mutators) {
+                mutator.join();
+            }
+
+            //check
+            GC::collect();
+            bool valid = true;
+            for (size_t index = 0; index < KeptCount; ++index) {
+                valid = valid && kept[index].get()[0] == index && kept[index].get()[1100 + index * 37 - 1] == index;
+            }
+            check(valid, "Reachable arrays should not have been destroyed");
+        }
+
+        //collect
+        size_t allocSize = GC::collect();
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        GC::setMarkerThreadCount(1);
+        GC::setConcurrentMarking(false);
+    });
+}
+
+
+void test37() {
+    struct Node {
+        int value;
+        Node(int value) : value(value) {}
+        ~Node() { value = -1; }
+    };
+
+    //member pointers within the object; the optional one is destroyed while the object is reachable
+    struct Pair {
+        GCPtr<Node> first;
+        GCPtr<Node> second;
+        std::optional<GCPtr<Node>> extra;
+        Pair(int value) : first(gcnew<Node>(value)), second(gcnew<Node>(value)), extra(gcnew<Node>(value)) {}
+    };
+
+    //member pointers outside of the object
+    struct Holder {
+        std::vector<GCPtr<Node>> children;
+        Holder(int value) {
+            for (int index = 0; index < 16; ++index) {
+                children.push_back(gcnew<Node>(value));
+            }
+        }
+    };
+
+    doTest("pointers stored and member pointers destroyed during concurrent marking", []() {
+        size_t prevAllocSize = GC::getAllocSize();
+        GC::setConcurrentMarking(true);
+        GC::setMarkerThreadCount(4);
+
+        {
+            const int ObjectCount = 256;
+            std::vector<GCPtr<Pair>> pairs;
+            std::vector<GCPtr<Holder>> holders;
+            for (int index = 0; index < ObjectCount; ++index) {
+                pairs.push_back(gcnew<Pair>(index));
+                holders.push_back(gcnew<Holder>(index));
+            }
+
+            //each thread moves the pointers of its own objects around, and replaces some of them
+            std::atomic<bool> stop{ false };
+            std::vector<std::thread> mutators;
+            for (int threadIndex = 0; threadIndex < 2; ++threadIndex) {
+                mutators.emplace_back([&, threadIndex]() {
+                    std::mt19937 random(threadIndex);
+                    while (!stop.load(std::memory_order_relaxed)) {
+                        const int index = static_cast<int>(random() % (ObjectCount / 2)) * 2 + threadIndex;
+                        Pair& pair = *pairs[index];
+                        GCPtr<Node> node = pair.first;
+                        pair.first = pair.second;
+                        pair.second = node;
+                        pair.extra.reset();
+                        pair.extra.emplace(gcnew<Node>(index));
+                        std::vector<GCPtr<Node>>& children = holders[index]->children;
+                        node = children[random() % children.size()];
+                        children[random() % children.size()] = gcnew<Node>(index);
+                        children[random() % children.size()] = node;
+                    }
+                });
+            }
+            for (int index = 0; index < 20; ++index) {
+                GC::collect();
+            }
+            stop = true;
+            for (std::thread& mutator : mutators) {
+                mutator.join();
+            }
+
+            //check
+            GC::collect();
+            bool valid = true;
+            for (int index = 0; index < ObjectCount; ++index) {
+                valid = valid && pairs[index]->first->value == index && pairs[index]->second->value == index && (*pairs[index]->extra)->value == index;
+                for (const GCPtr<Node>& child : holders[index]->children) {
+                    valid = valid && child->value == index;
+                }
+            }
+            check(valid, "Reachable objects should not have been destroyed");
+        }
+
+        //collect; the pointers emplaced in the optional members after construction are roots,
+        //and therefore their nodes are collected after the pairs are finalized
+        GC::collect();
+        size_t allocSize = GC::collect();
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        GC::setMarkerThreadCount(1);
+        GC::setConcurrentMarking(false);
+    });
+}
+
+
+void test38() {
+    doTest("incremental marking, node moved between slices", []() {
+        size_t prevAllocSize = GC::getAllocSize();
+        GC::setPauseBudget(std::chrono::microseconds(100));
+        int prevCount = count;
+
+        {
+            //create a long list; its last node is reachable only through the list
+            const int NodeCount = 100000;
+            GCPtr<ListNode> head = gcnew<ListNode>();
+            ListNode* last = head.get();
+            for (int index = 1; index < NodeCount; ++index) {
+                last->next = gcnew<ListNode>();
+                last = last->next.get();
+            }
+            GCPtr<ListNode> spare = gcnew<ListNode>();
+
+            //another thread moves a node between the end of the list and a root, while collections mark the list in slices
+            std::atomic<bool> stop{ false };
+            std::thread mutator([&]() {
+                while (!stop.load(std::memory_order_relaxed)) {
+                    if (spare) {
+                        last->next = spare;
+                        spare = nullptr;
+                    }
+                    else {
+                        spare = last->next;
+                        last->next = nullptr;
+                    }
+                    gcnew<Point>();
+                }
+            });
+            int incompleteCount = 0;
+            for (int index = 0; index < 5; ++index) {
+                GC::collect();
+                if (GC::isCollecting()) {
+                    ++incompleteCount;
+                }
+                while (GC::isCollecting()) {
+                    GC::collect();
+                }
+            }
+            stop = true;
+            mutator.join();
+
+            //check
+            check(incompleteCount > 0, "Marking should have been split in slices");
+            GC::collectFull();
+            check(count == prevCount + NodeCount + 1, "Reachable nodes should not have been destroyed");
+
+            //a thread moves the last node to another root node between slices, then it exits before marking completes;
+            //its data are deleted, but the node must survive, since the thread recorded it when it overwrote it
+            if (!last->next) {
+                last->next = spare;
+                spare = nullptr;
+            }
+            GCPtr<ListNode> holder = gcnew<ListNode>();
+            GC::collect();
+            const bool incomplete = GC::isCollecting();
+            std::thread([&]() {
+                GCPtr<ListNode> node = last->next;
+                last->next = nullptr;
+                holder->next = node;
+            }).join();
+            while (GC::isCollecting()) {
+                GC::collect();
+            }
+            check(incomplete, "Marking should have been split in slices");
+            check(count == prevCount + NodeCount + 2, "Node moved by an exited thread should not have been destroyed");
+        }
+
+        //collect
+        size_t allocSize = GC::collectFull();
+
+        //check
+        check(!GC::isCollecting(), "Incremental collection should have been completed");
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount, "Nodes not destroyed correctly");
+        GC::setPauseBudget(std::chrono::microseconds(0));
+    });
+}
+
+
+void test39() {
+    doTest("incremental slice ends while the collection thread is busy", []() {
+        size_t prevAllocSize = GC::getAllocSize();
+        GC::setPauseBudget(std::chrono::microseconds(1));
+        int prevCount = count;
+
+        {
+            //a list long enough to be marked in many slices
+            const int NodeCount = 100000;
+            GCPtr<ListNode> head = gcnew<ListNode>();
+            ListNode* last = head.get();
+            for (int index = 1; index < NodeCount; ++index) {
+                last->next = gcnew<ListNode>();
+                last = last->next.get();
+            }
+
+            //the collection thread is woken up, then this thread starts a collection, 
+            //whose first slice ends while the collection thread runs or is about to wait again;
+            //the request of the slice must not be lost, otherwise the collection is never completed
+            int stuckCount = 0;
+            for (int index = 0; index < 1000 && stuckCount == 0; ++index) {
+                GC::collectAsync();
+                GC::collect();
+                const auto start = std::chrono::steady_clock::now();
+                while (GC::isCollecting() && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                if (GC::isCollecting()) {
+                    ++stuckCount;
+                }
+            }
+
+            //check; the collection is completed by this thread if it was stuck
+            check(stuckCount == 0, "Incremental collection was not continued by the collection thread");
+            while (GC::isCollecting()) {
+                GC::collect();
+            }
+            check(count == prevCount + NodeCount, "Reachable nodes should not have been destroyed");
+        }
+
+        //collect; a collection fails while the collection thread collects, 
+        //and a collection the thread started while the list was reachable does not collect the list
+        GC::setPauseBudget(std::chrono::microseconds(0));
+        size_t allocSize = GC::collectFull();
+        for (int index = 0; index < 1000 && count != prevCount; ++index) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            allocSize = GC::collectFull();
+        }
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount, "Nodes not destroyed correctly");
+    });
+}
+
+
+struct TracedTreeNode {
+    GCBasicPtr<TracedTreeNode> left;
+    GCBasicPtr<TracedTreeNode> right;
+
+    TracedTreeNode() {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~TracedTreeNode() {
+        count.fetch_sub(1, std::memory_order_relaxed);
+    }
+};
+
+
+GC_TRACE(TracedTreeNode, left, right);
+
+
+static GCPtr<TracedTreeNode> createTracedTree(int depth) {
+    GCPtr<TracedTreeNode> node = gcnew<TracedTreeNode>();
+    if (depth > 1) {
+        node->left = createTracedTree(depth - 1);
+        node->right = createTracedTree(depth - 1);
+    }
+    return node;
+}
+
+
+void test40() {
+    doTest("pointer layout declared with GC_TRACE", []() {
+        size_t prevAllocSize = GC::getAllocSize();
+        int prevCount = count;
+
+        check(GCBlockHeaderVTable<TracedTreeNode>::Traits & GCIBlockHeaderVTable::Traced, "TracedTreeNode should be traced");
+        check(!(GCBlockHeaderVTable<TracedTreeNode>::Traits & GCIBlockHeaderVTable::NoPtrs), "TracedTreeNode should have ptrs");
+        check(sizeof(TracedTreeNode) == 2 * sizeof(void*), "Traced pointers should be plain pointers");
+
+        {
+            //nodes reachable only through traced members must survive
+            const int NodeCount = (1 << 16) - 1;
+            GCPtr<TracedTreeNode> root = createTracedTree(16);
+            GC::collect();
+            check(count == prevCount + NodeCount, "Traced nodes should not have been destroyed");
+
+            //the objects of arrays are traced one after the other
+            GCPtr<TracedTreeNode> array = gcnewArray<TracedTreeNode>(4);
+            for (int index = 0; index < 4; ++index) {
+                array[index].right = gcnew<TracedTreeNode>();
+            }
+            GC::collect();
+            check(count == prevCount + NodeCount + 8, "Nodes reachable from traced array should not have been destroyed");
+
+            //unreachable subtrees are collected
+            root->left = nullptr;
+            GC::collect();
+            check(count == prevCount + NodeCount / 2 + 1 + 8, "Unreachable traced nodes should have been destroyed");
+        }
+
+        //collect
+        size_t allocSize = GC::collect();
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount, "Nodes not destroyed correctly");
+    });
+}
+
+
+void test41() {
+    doTest("constant type descriptors", []() {
+        constexpr const GCTypeDescriptor& pointDescriptor = GCBlockHeaderVTable<Point>::Descriptor<>;
+        static_assert(pointDescriptor.traits == GCIBlockHeaderVTable::Trivial, "Point descriptor should be trivial");
+        check(pointDescriptor.scanFunction == nullptr && pointDescriptor.finalizeFunction == nullptr && pointDescriptor.sharedFunction == nullptr, "Point descriptor should have no scan/finalize/shared function");
+        check(pointDescriptor.freeFunction == &GCBlockHeaderVTable<Point>::freeMemory && pointDescriptor.vtable == nullptr, "Point descriptor should have a direct free function");
+
+        constexpr const GCTypeDescriptor& listNodeDescriptor = GCBlockHeaderVTable<ListNode>::Descriptor<>;
+        check(listNodeDescriptor.scanFunction == nullptr && listNodeDescriptor.finalizeFunction == &GCBlockHeaderVTable<ListNode>::finalizeObjects, "ListNode descriptor should only finalize");
+        check(GCBlockHeaderVTable<Node1>::Descriptor<>.scanFunction == &GCBlockHeaderVTable<Node1>::scanObjects, "Node1 descriptor should scan");
+        check(GCBlockHeaderVTable<SharedObject>::Descriptor<>.sharedFunction == &GCBlockHeaderVTable<SharedObject>::sharedObjects, "SharedObject descriptor should check sharing");
+
+        //type ids are assigned once per descriptor
+        const uint16_t pointTypeId = GCTypeId<GCBlockHeaderVTable<Point>::Descriptor<>>::getIndex();
+        check(pointTypeId != 0 && pointTypeId == GCTypeId<GCBlockHeaderVTable<Point>::Descriptor<>>::getIndex(), "Point type id should be stable");
+        check(pointTypeId != GCTypeId<GCBlockHeaderVTable<ListNode>::Descriptor<>>::getIndex(), "Type ids should be distinct");
+
+        //vtable objects register a copy of the descriptor that refers back to them
+        GCBlockHeaderVTable<ListNode> vtable;
+        check(vtable.getDescriptor().vtable == &vtable && vtable.getDescriptor().finalizeFunction == listNodeDescriptor.finalizeFunction, "VTable descriptor not initialized correctly");
+
+        //the type ids of unregistered vtables are reused
+        uint16_t releasedTypeId;
+        {
+            GCBlockHeaderVTable<ListNode> tempVTable;
+            releasedTypeId = tempVTable.getIndex();
+        }
+        GCBlockHeaderVTable<ListNode> nextVTable;
+        check(nextVTable.getIndex() == releasedTypeId, "Type id of unregistered vtable should be reused");
+
+        //registering more descriptors than the registry can hold fails with an exception
+        std::vector<std::unique_ptr<GCBlockHeaderVTable<ListNode>>> vtables;
+        bool full = false;
+        try {
+            while (vtables.size() <= 65536) {
+                vtables.push_back(std::make_unique<GCBlockHeaderVTable<ListNode>>());
+            }
+        }
+        catch (const std::runtime_error&) {
+            full = true;
+        }
+        check(full && vtables.size() < 65536, "Registering too many vtables should fail");
+    });
+}
+
+
+struct ListNodeArray : GCIScannableObject {
+    GCBasicPtr<ListNode> items[8];
+
+    void scan(GCTracer& tracer) const noexcept final {
+        tracer.visit(reinterpret_cast<const void* const*>(items), 8);
+    }
+};
+
+
+void scanListNodeData(void* mem, GCTracer& tracer) {
+    tracer.visit(*reinterpret_cast<ListNode**>(mem));
+}
+
+
+void test42() {
+    doTest("manual tracing via tracer, 4 marker threads", []() {
+        const size_t prevMarkerThreadCount = GC::getMarkerThreadCount();
+        GC::setMarkerThreadCount(4);
+        size_t prevAllocSize = GC::getAllocSize();
+        int prevCount = count;
+
+        {
+            //nodes reachable only through manually traced pointers must survive
+            const int NodeCount = (1 << 14) - 1;
+            GCPtr<Node1> root = gcnew<Node1>(14);
+            check(count == prevCount + NodeCount, "Nodes not created correctly");
+            GC::collect();
+            check(count == prevCount + NodeCount, "Manually traced nodes should not have been destroyed");
+
+            //batch visit
+            GCPtr<ListNodeArray> array = gcnew<ListNodeArray>();
+            for (GCBasicPtr<ListNode>& item : array->items) {
+                item = gcnew<ListNode>();
+            }
+            GC::collect();
+            check(count == prevCount + NodeCount + 8, "Nodes visited in batch should not have been destroyed");
+
+            //custom vtable scan function with tracer
+            GCCustomBlockHeaderVTable vtable{ &scanListNodeData, [](void*) {}, &freeData, &dataShared };
+            GCPtr<ListNode*> data = gcnew<ListNode*>(sizeof(ListNode*), [](size_t size) { return malloc(size); }, [](void* mem) {
+                return ::new(mem) ListNode*(nullptr);
+            }, vtable);
+            *data = gcnew<ListNode>().get();
+            GC::collect();
+            check(count == prevCount + NodeCount + 9, "Node visited from custom scan function should not have been destroyed");
+            data = nullptr;
+            GC::collect();
+        }
+
+        //collect
+        size_t allocSize = GC::collect();
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount, "Nodes not destroyed correctly");
+        GC::setMarkerThreadCount(prevMarkerThreadCount);
+    });
+}
+
+
+static const size_t PointerTableSize = 1 << 20;
+static const size_t PointerTableNodeCount = 1000;
+
+
+//creates a table of pointers that are mostly null or point outside of the heap
+static GCPtr<GCBasicPtr<ListNode>> createPointerTable() {
+    static int notInHeap[16];
+    GCPtr<GCBasicPtr<ListNode>> table = gcnewArray<GCBasicPtr<ListNode>>(PointerTableSize);
+    for (size_t index = 0; index < PointerTableSize; index += 64) {
+        table[index] = reinterpret_cast<ListNode*>(&notInHeap[index / 64 % 16]);
+        table[index + 1] = reinterpret_cast<ListNode*>(~uintptr_t(0) - index);
+    }
+    for (size_t index = 0; index < PointerTableNodeCount; ++index) {
+        table[index * (PointerTableSize / PointerTableNodeCount) + 7] = gcnew<ListNode>();
+    }
+    return table;
+}
+
+
+void test43() {
+    doTest("pointer tables filtered in batches", []() {
+        size_t prevAllocSize = GC::getAllocSize();
+        int prevCount = count;
+        check(GCBlockHeaderVTable<GCBasicPtr<ListNode>[]>::Traits & GCIBlockHeaderVTable::Traced, "Pointer table should be traced");
+
+        {
+            //the nodes are reachable only from the table
+            GCPtr<GCBasicPtr<ListNode>> table = createPointerTable();
+            GC::collect();
+            check(count == prevCount + static_cast<int>(PointerTableNodeCount), "Nodes in pointer table should not have been destroyed");
+
+            //nodes removed from the table are collected
+            for (size_t index = 0; index < PointerTableNodeCount; index += 2) {
+                table[index * (PointerTableSize / PointerTableNodeCount) + 7] = nullptr;
+            }
+            GC::collect();
+            check(count == prevCount + static_cast<int>(PointerTableNodeCount / 2), "Nodes removed from pointer table should have been destroyed");
+        }
+
+        //collect
+        size_t allocSize = GC::collect();
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount, "Nodes not destroyed correctly");
+    });
+}
+
+
+struct GraphNode {
+    GCPtr<GraphNode> edges[4];
+
+    GraphNode() {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~GraphNode() {
+        count.fetch_sub(1, std::memory_order_relaxed);
+    }
+};
+
+
+//creates a graph of nodes with random edges; all nodes are reachable from the first one,
+//but the nodes of the first half do not point to the nodes of the second half
+static GCPtr<GraphNode> createRandomGraph(size_t nodeCount, unsigned seed) {
+    std::mt19937 random(seed);
+    std::vector<GCPtr<GraphNode>> nodes(nodeCount);
+    for (GCPtr<GraphNode>& node : nodes) {
+        node = gcnew<GraphNode>();
+    }
+    const size_t halfCount = nodeCount / 2;
+    for (size_t index = 0; index < nodeCount; ++index) {
+        const size_t range = index < halfCount ? halfCount : nodeCount;
+        nodes[index]->edges[0] = nodes[(index + 1) % nodeCount];
+        for (size_t edge = 1; edge < 4; ++edge) {
+            nodes[index]->edges[edge] = nodes[random() % range];
+        }
+    }
+    nodes[halfCount - 1]->edges[0] = nodes[0];
+    return nodes[0];
+}
+
+
+void test44() {
+    doTest("prefetching in the mark loop", []() {
+        const size_t prevPrefetchDistance = GC::getPrefetchDistance();
+        const size_t prevMarkerThreadCount = GC::getMarkerThreadCount();
+        size_t prevAllocSize = GC::getAllocSize();
+        int prevCount = count;
+
+        GC::setPrefetchDistance(1000);
+        check(GC::getPrefetchDistance() == 32, "Prefetch distance should have been clamped");
+
+        //the results are the same for any prefetch distance and any number of marker threads
+        const int NodeCount = 1 << 14;
+        for (size_t markerThreadCount : { 1, 4 }) {
+            GC::setMarkerThreadCount(markerThreadCount);
+            for (size_t prefetchDistance : { 0, 1, 5, 32 }) {
+                GC::setPrefetchDistance(prefetchDistance);
+                {
+                    GCPtr<GraphNode> root = createRandomGraph(NodeCount, static_cast<unsigned>(prefetchDistance));
+                    check(count == prevCount + NodeCount, "Graph not created correctly");
+                    GC::collect();
+                    check(count == prevCount + NodeCount / 2, "Unreachable half of the graph should have been destroyed");
+                    GC::collect();
+                    check(count == prevCount + NodeCount / 2, "Reachable half of the graph should not have been destroyed");
+                }
+                GC::collect();
+                check(count == prevCount, "Graph should have been destroyed");
+            }
+        }
+
+        //collect
+        size_t allocSize = GC::collect();
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount, "Nodes not destroyed correctly");
+        GC::setMarkerThreadCount(prevMarkerThreadCount);
+        GC::setPrefetchDistance(prevPrefetchDistance);
+    });
+}
+
+
+struct WeakHolder {
+    GCWeakPtr<Foo> weak;
+};
+
+
+struct WeakTarget {
+    int value{ 12345 };
+
+    WeakTarget() {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~WeakTarget() {
+        value = 0;
+        count.fetch_sub(1, std::memory_order_relaxed);
+    }
+};
+
+
+void test45() {
+    doTest("weak pointers", []() {
+        size_t prevAllocSize = GC::getAllocSize();
+        int prevCount = count;
+
+        {
+            //a cache keeps its entries alive only while they are reachable from elsewhere
+            const int CacheSize = 100;
+            std::vector<GCWeakPtr<Foo>> cache;
+            std::vector<GCPtr<Foo>> strongPtrs;
+            for (int index = 0; index < CacheSize; ++index) {
+                GCPtr<Foo> foo = gcnew<Foo>();
+                cache.push_back(foo);
+                if (index % 2 == 0) {
+                    strongPtrs.push_back(foo);
+                }
+            }
+            GC::collect();
+            check(count == prevCount + CacheSize / 2, "Objects reachable only from weak pointers should have been destroyed");
+            bool cacheCleared = true;
+            for (int index = 0; index < CacheSize; ++index) {
+                if (cache[index].expired() != (index % 2 == 1) || (cache[index].lock() == nullptr) != (index % 2 == 1)) {
+                    cacheCleared = false;
+                }
+            }
+            check(cacheCleared, "Weak pointers not cleared correctly");
+
+            //the objects are kept alive by the pointers returned from lock
+            GCPtr<Foo> upgraded = cache[0].lock();
+            GCWeakPtr<Foo> copy = cache[0];
+            strongPtrs.clear();
+            GC::collect();
+            check(count == prevCount + 1 && !copy.expired() && copy.lock() == upgraded, "Object locked via weak pointer should not have been destroyed");
+            upgraded = nullptr;
+            GC::collect();
+            check(count == prevCount && copy.expired() && cache[0].expired(), "Weak pointers to collected object should have been cleared");
+
+            //weak pointers within collected objects
+            GCPtr<WeakHolder> holder = gcnew<WeakHolder>();
+            holder->weak = gcnew<Foo>();
+            GC::collect();
+            check(count == prevCount && holder->weak.expired(), "Weak pointer within object should have been cleared");
+            GCPtr<Foo> foo = gcnew<Foo>();
+            holder->weak = foo;
+            holder = nullptr;
+            GC::collect();
+            check(count == prevCount + 1, "Object pointed by weak pointer of collected object should not have been destroyed");
+        }
+
+        {
+            //young collections do not clear the weak pointers to old objects
+            const bool prevGenerational = GC::getGenerational();
+            const size_t prevPromotionAge = GC::getPromotionAge();
+            GC::setGenerational(true);
+            GC::setPromotionAge(1);
+            GC::collect();
+            GCPtr<Foo> foo = gcnew<Foo>();
+            GCWeakPtr<Foo> weak = foo;
+            GC::collect();
+            foo = nullptr;
+            GC::collect();
+            check(!weak.expired(), "Weak pointer to old object should not have been cleared by young collection");
+            GC::collectFull();
+            check(weak.expired(), "Weak pointer to old object should have been cleared by full collection");
+            GC::setGenerational(prevGenerational);
+            GC::setPromotionAge(prevPromotionAge);
+        }
+
+        {
+            //threads lock a weak pointer while it is modified, and while objects are marked along with them
+            const bool prevConcurrentMarking = GC::getConcurrentMarking();
+            GC::setConcurrentMarking(true);
+            GCWeakPtr<WeakTarget> weak;
+            std::atomic<bool> done{ false };
+            std::atomic<size_t> invalidCount{ 0 };
+            std::vector<std::thread> threads;
+            for (int index = 0; index < 4; ++index) {
+                threads.emplace_back([&]() {
+                    while (!done.load(std::memory_order_acquire)) {
+                        //the object might be locked after the roots are scanned, and held until after the final pause
+                        {
+                            GCPtr<WeakTarget> target = weak.lock();
+                            std::this_thread::sleep_for(std::chrono::microseconds(100));
+                            if (target && target->value != 12345) {
+                                invalidCount.fetch_add(1, std::memory_order_relaxed);
+                            }
+                        }
+                        std::this_thread::sleep_for(std::chrono::microseconds(300));
+                    }
+                });
+            }
+            for (int index = 0; index < 200; ++index) {
+                weak = gcnew<WeakTarget>();
+                GC::collect();
+            }
+            done.store(true, std::memory_order_release);
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+            check(invalidCount == 0, "Object locked via weak pointer was destroyed");
+            GC::setConcurrentMarking(prevConcurrentMarking);
+        }
+
+        {
+            //an object locked between the slices of an incremental collection, after the roots are scanned, is not collected
+            const std::chrono::microseconds prevPauseBudget = GC::getPauseBudget();
+            GCPtr<GraphNode> graph = createRandomGraph(1 << 16, 0);
+            GCWeakPtr<WeakTarget> weak = gcnew<WeakTarget>();
+            GC::setPauseBudget(std::chrono::microseconds(1));
+            GC::collect();
+            GCPtr<WeakTarget> target = weak.lock();
+            GC::setPauseBudget(prevPauseBudget);
+            GC::collectFull();
+            check(target && !weak.expired() && target->value == 12345, "Object locked during incremental collection was destroyed");
+            graph = nullptr;
+        }
+
+        //collect
+        size_t allocSize = GC::collect();
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount, "Objects not destroyed correctly");
+    });
+}
+
+
+//collects a tree of the given depth and returns the longest pause of the collection
+template <class T> static std::chrono::microseconds measureLongestPause(int depth) {
+    //the garbage of earlier measurements is collected first, so as that only the nodes of the tree are counted
+    GCPtr<T> root = gcnew<T>(depth);
+    GC::collect();
+    const int prevCount = count;
+    GC::collect();
+    check(count == prevCount, "Reachable nodes should not have been destroyed");
+    return GC::getLastPauseDuration();
+}
+
+
+void test46() {
+    doTest("final pause of concurrent marking, 2^17 nodes with gc pointers or manually traced pointers", []() {
+        size_t prevAllocSize = GC::getAllocSize();
+        int prevCount = count;
+        GC::setConcurrentMarking(true);
+
+        //objects with manually traced pointers are scanned in the final pause
+        const std::chrono::microseconds ptrPause = measureLongestPause<Node>(17);
+        const std::chrono::microseconds scannablePause = measureLongestPause<Node1>(17);
+        check(ptrPause.count() > 0 && scannablePause.count() > 0, "Pause durations not measured");
+
+        //collect
+        GC::setConcurrentMarking(false);
+        size_t allocSize = GC::collect();
+
+        //check
+        check(allocSize == prevAllocSize, "Data not collected correctly");
+        check(count == prevCount, "Nodes should have been destroyed");
+    });
+}
+
+
 int main() {
     std::cout << std::fixed;
 
@@ -697,6 +2223,33 @@ int main() {
     test17();
     test18();
     test19();
+    test20();
+    test21();
+    test22();
+    test23();
+    test24();
+    test25();
+    test26();
+    test27();
+    test28();
+    test29();
+    test30();
+    test31();
+    test32();
+    test33();
+    test34();
+    test35();
+    test36();
+    test37();
+    test38();
+    test39();
+    test40();
+    test41();
+    test42();
+    test43();
+    test44();
+    test45();
+    test46();
 
     if (errorCount > 0) {
         std::cout << "Errors: " << errorCount << std::endl;